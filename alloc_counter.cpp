@@ -0,0 +1,109 @@
+#include "alloc_counter.h"
+
+#ifdef AUDIO_SPECTRUM_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::size_t> s_totalCount{ 0 };
+	thread_local std::size_t s_threadCount{ 0 };
+
+	// count and forward to malloc, which never calls back into operator new
+	void* countedAllocate(std::size_t size)
+	{
+		++s_threadCount;
+		s_totalCount.fetch_add(1, std::memory_order_relaxed);
+		return std::malloc(size ? size : 1);
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	void* memory{ countedAllocate(size) };
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t &) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t &) noexcept
+{
+	std::free(memory);
+}
+#endif
+
+namespace AllocationCounter
+{
+	// retrieve whether allocations are counted in this build
+	bool isEnabled()
+	{
+#ifdef AUDIO_SPECTRUM_COUNT_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// retrieve the amount of allocations made by the calling thread
+	std::size_t getThreadCount()
+	{
+#ifdef AUDIO_SPECTRUM_COUNT_ALLOCATIONS
+		return s_threadCount;
+#else
+		return 0;
+#endif
+	}
+
+	// retrieve the amount of allocations made by every thread
+	std::size_t getTotalCount()
+	{
+#ifdef AUDIO_SPECTRUM_COUNT_ALLOCATIONS
+		return s_totalCount.load(std::memory_order_relaxed);
+#else
+		return 0;
+#endif
+	}
+}
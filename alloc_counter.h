@@ -0,0 +1,27 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+/*
+	Counts heap allocations made through the global operator new. The
+	counting replacements of operator new and delete are only compiled
+	when AUDIO_SPECTRUM_COUNT_ALLOCATIONS is defined; otherwise every count is
+	zero and the standard allocator is untouched.
+
+	Counts are kept per thread as well as in total, so a loop can check
+	that its own steady state frames allocate nothing while other threads
+	(decoding, cache building) keep allocating:
+
+		const std::size_t before{ AllocationCounter::getThreadCount() };
+		runFrame();
+		assert(AllocationCounter::getThreadCount() == before);
+*/
+namespace AllocationCounter
+{
+	bool isEnabled();				// retrieve whether allocations are counted in this build
+	std::size_t getThreadCount();	// retrieve the amount of allocations made by the calling thread
+	std::size_t getTotalCount();	// retrieve the amount of allocations made by every thread
+}
+
+#endif
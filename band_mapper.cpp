@@ -0,0 +1,208 @@
+#include "band_mapper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BAND_MAPPER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// weights of every band are padded to a multiple of this many bins
+	const int s_lanes{ 4 };
+
+	// convert a frequency in Hz to a position on a scale
+	double toScale(BandMapper::Scale scale, double frequency)
+	{
+		switch (scale)
+		{
+		case BandMapper::Mel:
+			return 2595.0 * std::log10(1.0 + frequency / 700.0);
+		case BandMapper::Bark:
+			return 26.81 * frequency / (1960.0 + frequency) - 0.53;
+		default:
+			return std::log(frequency);
+		}
+	}
+
+	// convert a position on a scale back to a frequency in Hz
+	double fromScale(BandMapper::Scale scale, double position)
+	{
+		switch (scale)
+		{
+		case BandMapper::Mel:
+			return 700.0 * (std::pow(10.0, position / 2595.0) - 1.0);
+		case BandMapper::Bark:
+			return 1960.0 * (position + 0.53) / (26.28 - position);
+		default:
+			return std::exp(position);
+		}
+	}
+}
+
+// default constructor, maps nothing until built
+BandMapper::BandMapper() : binCount{ 0 }
+{
+	bandOffset.push_back(0);
+}
+
+// builds bandCount bands evenly spaced on a frequency scale
+bool BandMapper::build(Scale scale, int bandCount, int binCount, int sampleRate, double minFrequency, double maxFrequency)
+{
+	maxFrequency = std::min(maxFrequency, sampleRate / 2.0);
+	if (bandCount < 1 || minFrequency <= 0.0 || maxFrequency <= minFrequency)
+	{
+		std::cerr << "BandMapper::build(): invalid band count or frequency range\n";
+		return false;
+	}
+
+	const double low{ toScale(scale, minFrequency) };
+	const double high{ toScale(scale, maxFrequency) };
+	std::vector<double> edges;
+	for (int edge{ 0 }; edge <= bandCount; ++edge)
+	{
+		edges.push_back(fromScale(scale, low + (high - low) * edge / bandCount));
+	}
+	return buildFromEdges(edges, binCount, sampleRate);
+}
+
+// builds fractional octave bands centered on 1000 * 2^(k / fraction) Hz
+bool BandMapper::buildOctaves(int fraction, int binCount, int sampleRate, double minFrequency, double maxFrequency)
+{
+	maxFrequency = std::min(maxFrequency, sampleRate / 2.0);
+	if (fraction < 1 || minFrequency <= 0.0 || maxFrequency <= minFrequency)
+	{
+		std::cerr << "BandMapper::buildOctaves(): invalid fraction or frequency range\n";
+		return false;
+	}
+
+	// band indices relative to 1 kHz, edges lie half a band from each center
+	const int first{ static_cast<int>(std::ceil(fraction * std::log2(minFrequency / 1000.0) - 1e-9)) };
+	const int last{ static_cast<int>(std::floor(fraction * std::log2(maxFrequency / 1000.0) + 1e-9)) };
+	if (last < first)
+	{
+		std::cerr << "BandMapper::buildOctaves(): no band center in the frequency range\n";
+		return false;
+	}
+
+	std::vector<double> edges;
+	for (int band{ first }; band <= last + 1; ++band)
+	{
+		edges.push_back(1000.0 * std::pow(2.0, (band - 0.5) / fraction));
+	}
+	edges.back() = std::min(edges.back(), sampleRate / 2.0);
+	return buildFromEdges(edges, binCount, sampleRate);
+}
+
+// compute weights of bands between consecutive edges (in Hz)
+bool BandMapper::buildFromEdges(const std::vector<double> &edges, int binCount, int sampleRate)
+{
+	if (binCount < s_lanes || sampleRate <= 0)
+	{
+		std::cerr << "BandMapper::buildFromEdges(): need at least " << s_lanes << " bins and a sample rate\n";
+		return false;
+	}
+
+	this->binCount = binCount;
+	bandStart.clear();
+	bandOffset.assign(1, 0);
+	weights.clear();
+
+	const double binWidth{ sampleRate / (2.0 * binCount) };
+	std::vector<float> run;
+	for (std::size_t band{ 0 }; band + 1 < edges.size(); ++band)
+	{
+		// band edges in units of bins, bin k covers [k - 0.5, k + 0.5]
+		const double low{ edges[band] / binWidth };
+		const double high{ edges[band + 1] / binWidth };
+		int start;
+		run.clear();
+		if (high - low <= 1.0)
+		{
+			// narrower than a bin, interpolate at the band center
+			const double center{ std::min((low + high) / 2.0, binCount - 1.0) };
+			start = std::min(static_cast<int>(center), binCount - 2);
+			const float fraction{ static_cast<float>(center - start) };
+			run.push_back(1.0f - fraction);
+			run.push_back(fraction);
+		}
+		else
+		{
+			// average the bins the band overlaps, weighted by the overlap
+			start = std::min(std::max(static_cast<int>(std::floor(low + 0.5)), 0), binCount - 1);
+			const int end{ std::max(std::min(static_cast<int>(std::ceil(high - 0.5)), binCount - 1), start) };
+			double total{ 0.0 };
+			for (int bin{ start }; bin <= end; ++bin)
+			{
+				const double overlap{ std::max(std::min(high, bin + 0.5) - std::max(low, bin - 0.5), 0.0) };
+				run.push_back(static_cast<float>(overlap));
+				total += overlap;
+			}
+			for (auto &weight : run)
+			{
+				weight = total > 0.0 ? static_cast<float>(weight / total) : 1.0f / run.size();
+			}
+		}
+
+		// pad to whole SIMD lanes, shifting the run back at the end of the bins
+		const int length{ (static_cast<int>(run.size()) + s_lanes - 1) / s_lanes * s_lanes };
+		run.resize(length, 0.0f);
+		const int shift{ std::max(start + length - binCount, 0) };
+		if (shift > 0)
+		{
+			run.insert(run.begin(), shift, 0.0f);
+			run.resize(length);
+			start -= shift;
+		}
+
+		bandStart.push_back(start);
+		weights.insert(weights.end(), run.begin(), run.end());
+		bandOffset.push_back(static_cast<int>(weights.size()));
+	}
+	return true;
+}
+
+// write the band values of binCount bin magnitudes to bandsOut
+void BandMapper::apply(const float* bins, float* bandsOut) const
+{
+	const int bandCount{ getBandCount() };
+	for (int band{ 0 }; band < bandCount; ++band)
+	{
+		const float* weight{ weights.data() + bandOffset[band] };
+		const float* bin{ bins + bandStart[band] };
+		const int length{ bandOffset[band + 1] - bandOffset[band] };
+#ifdef BAND_MAPPER_SSE2
+		__m128 sum{ _mm_setzero_ps() };
+		for (int x{ 0 }; x < length; x += s_lanes)
+		{
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(weight + x), _mm_loadu_ps(bin + x)));
+		}
+		// add the four lanes together
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		bandsOut[band] = _mm_cvtss_f32(sum);
+#else
+		float sum{ 0.0f };
+		for (int x{ 0 }; x < length; ++x)
+		{
+			sum += weight[x] * bin[x];
+		}
+		bandsOut[band] = sum;
+#endif
+	}
+}
+
+// retrieve the amount of bands
+int BandMapper::getBandCount() const
+{
+	return static_cast<int>(bandStart.size());
+}
+
+// retrieve the amount of bins read by apply()
+int BandMapper::getBinCount() const
+{
+	return binCount;
+}
@@ -0,0 +1,77 @@
+#ifndef BAND_MAPPER_H
+#define BAND_MAPPER_H
+
+#include <vector>
+
+/*
+	Maps FFT bin magnitudes to display bands. The bins feeding each band
+	and their weights are computed once and stored as a sparse matrix in
+	compressed rows: every band keeps the first bin it reads and a run of
+	weights in one contiguous array. Runs are padded with zero weights to
+	a multiple of four so apply() is a single SIMD pass with no tails.
+
+	Bands wider than a bin average the bins they overlap, weighted by the
+	overlap; bands narrower than a bin interpolate between the two bins
+	around their center, so low bands do not repeat the same bin.
+*/
+class BandMapper
+{
+public:
+	// frequency scales band edges are evenly spaced on
+	enum Scale
+	{
+		Log,		// log frequency
+		Mel,		// 2595 log10(1 + f / 700)
+		Bark		// Traunmuller critical band rate
+	};
+
+	// default constructor, maps nothing until built
+	BandMapper();
+
+	/*
+		Builds bandCount bands evenly spaced on a frequency scale.
+
+		scale - scale the band edges are spaced on
+		bandCount - amount of bands
+		binCount - amount of magnitude bins passed to apply()
+		sampleRate - sample rate in Hz (bin spacing is sampleRate / (2 * binCount))
+		minFrequency - lower edge of the first band in Hz
+		maxFrequency - upper edge of the last band in Hz, limited to nyquist
+
+		Returns true on success and false on failure.
+	*/
+	bool build(Scale scale, int bandCount, int binCount, int sampleRate, double minFrequency, double maxFrequency);
+
+	/*
+		Builds fractional octave bands centered on 1000 * 2^(k / fraction) Hz,
+		the preferred centers of IEC 61260 (fraction 3 gives third octaves).
+		The band count follows from the frequency range.
+
+		fraction - bands per octave
+		binCount - amount of magnitude bins passed to apply()
+		sampleRate - sample rate in Hz
+		minFrequency - lowest band center in Hz
+		maxFrequency - highest band center in Hz, limited to nyquist
+
+		Returns true on success and false on failure.
+	*/
+	bool buildOctaves(int fraction, int binCount, int sampleRate, double minFrequency, double maxFrequency);
+
+	// write the band values of binCount bin magnitudes to bandsOut
+	void apply(const float* bins, float* bandsOut) const;
+
+	int getBandCount() const;		// retrieve the amount of bands
+	int getBinCount() const;		// retrieve the amount of bins read by apply()
+
+private:
+	// compute weights of bands between consecutive edges (in Hz)
+	bool buildFromEdges(const std::vector<double> &edges, int binCount, int sampleRate);
+
+	int binCount;
+
+	std::vector<int> bandStart;		// first bin read by each band
+	std::vector<int> bandOffset;	// start of each band in weights, bandCount + 1 entries
+	std::vector<float> weights;		// padded weight runs of every band
+};
+
+#endif
@@ -0,0 +1,516 @@
+#define _USE_MATH_DEFINES
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include <SFML/Audio.hpp>
+#include <SFML/Window.hpp>
+
+#include "signal_generator.h"
+#include "../fft.h"
+#include "../sample_kernel.h"
+#include "../spectrum_kernel.h"
+#include "../band_mapper.h"
+#include "../spectrum.h"
+#include "../window.h"
+#include "../egl_context.h"
+#include "../offscreen_target.h"
+#include "../parallel_decoder.h"
+
+/*
+	Times every stage of the analysis and display pipeline, each in
+	isolation and then as one chain, on synthetic signals and the bundled
+	audio files, and writes the results as JSON:
+
+		benchmark [--audio dir] [--output file] [--frames n] [--fft n] [--no-gpu]
+
+	Frames step through each signal at the 60 fps display rate, like
+	playback does. Each bundled file is also decoded whole by
+	ParallelDecoder with 1, 2, 4, ... up to the hardware threads, which
+	reports its load time against the thread count. Built with AUDIO_SPECTRUM_HEADLESS the GPU stages run
+	on a surfaceless EGL context (llvmpipe on machines without a GPU),
+	otherwise on a hidden SFML context.
+*/
+
+namespace
+{
+	struct Options
+	{
+		std::string audioDirectory;
+		std::string outputPath;		// empty writes to stdout
+		int frames;					// frames timed per stage and signal
+		int fftSize;
+		bool gpu;					// whether the upload/draw stages run
+	};
+
+	// timings of one stage on one signal
+	struct Result
+	{
+		std::string stage;
+		std::string signal;
+		std::vector<double> nanoseconds;	// time of every frame
+		double units;						// work done over all frames, in unit
+		std::string unit;
+	};
+
+	// fastest whole-file load of a bundled file with one thread count
+	struct DecodeTiming
+	{
+		std::string file;
+		unsigned int threads;
+		double milliseconds;
+	};
+
+	const char* const s_bundledFiles[]{ "cmajor.ogg", "octaves.ogg", "slide.ogg", "tegami.ogg" };
+	const int s_displayRate{ 60 };
+	const std::size_t s_decodeBlock{ 4096 };
+	const int s_decodeRuns{ 3 };		// loads per thread count, the fastest one counts
+	const double s_syntheticSeconds{ 12.0 };
+
+	// same bands and scaling as the window
+	const int s_octaveFraction{ 12 };
+	const float s_intensity{ 0.20f };
+
+	typedef std::chrono::steady_clock Clock;
+
+	// nanoseconds since start
+	double elapsed(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	}
+
+	// parse the command line, returns false on unknown arguments
+	bool parseArguments(int argc, char* argv[], Options &optionsOut)
+	{
+		optionsOut.audioDirectory = "audio";
+		optionsOut.frames = 600;
+		optionsOut.fftSize = 8192;
+		optionsOut.gpu = true;
+		for (int arg{ 1 }; arg < argc; ++arg)
+		{
+			if (std::strcmp(argv[arg], "--audio") == 0 && arg + 1 < argc)
+			{
+				optionsOut.audioDirectory = argv[++arg];
+			}
+			else if (std::strcmp(argv[arg], "--output") == 0 && arg + 1 < argc)
+			{
+				optionsOut.outputPath = argv[++arg];
+			}
+			else if (std::strcmp(argv[arg], "--frames") == 0 && arg + 1 < argc)
+			{
+				optionsOut.frames = std::atoi(argv[++arg]);
+			}
+			else if (std::strcmp(argv[arg], "--fft") == 0 && arg + 1 < argc)
+			{
+				optionsOut.fftSize = std::atoi(argv[++arg]);
+			}
+			else if (std::strcmp(argv[arg], "--no-gpu") == 0)
+			{
+				optionsOut.gpu = false;
+			}
+			else
+			{
+				std::cerr << "Unknown argument " << argv[arg] << "\n"
+					<< "Usage: " << argv[0] << " [--audio dir] [--output file] [--frames n] [--fft n] [--no-gpu]\n";
+				return false;
+			}
+		}
+		const int size{ optionsOut.fftSize };
+		return optionsOut.frames > 0 && size >= 16 && (size & (size - 1)) == 0;
+	}
+
+	// decode a file block by block, timing every block
+	bool decode(const std::string &path, SignalGenerator::Signal &signalOut, Result &resultOut)
+	{
+		sf::InputSoundFile file;
+		if (!file.openFromFile(path))
+		{
+			return false;
+		}
+		signalOut.channelCount = static_cast<int>(file.getChannelCount());
+		signalOut.sampleRate = static_cast<int>(file.getSampleRate());
+		signalOut.samples.resize(static_cast<std::size_t>(file.getSampleCount()));
+
+		const std::size_t blockSamples{ s_decodeBlock * signalOut.channelCount };
+		std::size_t position{ 0 };
+		while (position < signalOut.samples.size())
+		{
+			const Clock::time_point start{ Clock::now() };
+			const std::size_t count{ std::min(blockSamples, signalOut.samples.size() - position) };
+			const std::size_t read{ static_cast<std::size_t>(file.read(signalOut.samples.data() + position, count)) };
+			resultOut.nanoseconds.push_back(elapsed(start));
+			if (read == 0)
+			{
+				break;
+			}
+			position += read;
+		}
+		signalOut.samples.resize(position);
+		resultOut.units = static_cast<double>(position / signalOut.channelCount);
+		resultOut.unit = "samples/s";
+		return position > 0;
+	}
+
+	// decode a file whole with 1, 2, 4, ... and the hardware amount of threads
+	void sweepDecodeThreads(const std::string &path, const std::string &file, std::vector<DecodeTiming> &timingsOut)
+	{
+		const unsigned int hardware{ std::max(std::thread::hardware_concurrency(), 1u) };
+		std::vector<unsigned int> threadCounts;
+		for (unsigned int threads{ 1 }; threads < hardware; threads *= 2)
+		{
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(hardware);
+
+		std::vector<sf::Int16> samples;
+		unsigned int channelCount;
+		unsigned int sampleRate;
+		for (unsigned int threads : threadCounts)
+		{
+			double fastest{ std::numeric_limits<double>::max() };
+			for (int run{ 0 }; run < s_decodeRuns; ++run)
+			{
+				const Clock::time_point start{ Clock::now() };
+				if (!ParallelDecoder::decode(path, samples, channelCount, sampleRate, threads))
+				{
+					return;
+				}
+				fastest = std::min(fastest, elapsed(start) / 1e6);
+			}
+			timingsOut.push_back({ file, threads, fastest });
+		}
+	}
+
+	/*
+		Buffers and GL objects of every stage, built once per signal so
+		only the work of each frame is timed.
+	*/
+	class Pipeline
+	{
+	public:
+		Pipeline(const Options &options, const SignalGenerator::Signal &signal, bool gpu)
+			: signal(signal), fftSize{ options.fftSize }, frameCount{ options.frames }, gpu{ gpu }, position{ 0 }
+		{
+			for (int x{ 0 }; x < fftSize; ++x)
+			{
+				const double y{ std::sin(M_PI * x / (fftSize - 1)) };
+				window.push_back(y * y);
+			}
+			bins.resize(fftSize);
+			magnitudes.resize(fftSize / 2);
+			bandMapper.buildOctaves(s_octaveFraction, fftSize / 2, signal.sampleRate, 20.0, 20000.0);
+			levels.resize(bandMapper.getBandCount());
+
+			rawMagnitudes = { SpectrumKernel::Magnitude, 1.0f, 0.0f, std::numeric_limits<float>::max() };
+			barHeights = { SpectrumKernel::Magnitude, s_intensity, 0.0f, 600.0f };
+		}
+
+		/*
+			Creates the render target and spectrum of the GPU stages, if
+			they run. Returns true on success and false on failure.
+		*/
+		bool create()
+		{
+			if (!gpu)
+			{
+				return true;
+			}
+			if (!target.create(Window::width, Window::height))
+			{
+				return false;
+			}
+			spectrum.reset(new Spectrum(bandMapper.getBandCount(), 1.0f));
+			spectrum->setViewport(Window::width, Window::height);
+			return true;
+		}
+
+		// run every stage and the whole chain, appending their results
+		void run(std::vector<Result> &results)
+		{
+			results.push_back(runStage("window", static_cast<double>(fftSize), "samples/s", &Pipeline::windowFrame, nullptr));
+			results.push_back(runStage("fft", 1.0, "transforms/s", &Pipeline::transform, &Pipeline::windowFrame));
+			results.push_back(runStage("magnitude", fftSize / 2.0, "bins/s", &Pipeline::magnitude, &Pipeline::prepareMagnitude));
+			results.push_back(runStage("bands", bandMapper.getBandCount(), "bands/s", &Pipeline::bands, &Pipeline::prepareBands));
+			if (gpu)
+			{
+				results.push_back(runStage("upload+draw", 1.0, "frames/s", &Pipeline::draw, &Pipeline::prepareDraw));
+			}
+			results.push_back(runStage("chain", 1.0, "frames/s", &Pipeline::chain, nullptr));
+		}
+
+	private:
+		typedef void (Pipeline::*Step)();
+
+		// time work on every frame, after untimed preparation of its input
+		Result runStage(const char* stage, double unitsPerFrame, const char* unit, Step work, Step prepare)
+		{
+			Result result;
+			result.stage = stage;
+			result.signal = signal.name;
+			result.units = unitsPerFrame * frameCount;
+			result.unit = unit;
+
+			const std::size_t frameLength{ signal.samples.size() / signal.channelCount };
+			const std::size_t hop{ static_cast<std::size_t>(signal.sampleRate / s_displayRate) };
+			const std::size_t positions{ frameLength > static_cast<std::size_t>(fftSize) ? frameLength - fftSize + 1 : 1 };
+			for (int frame{ 0 }; frame < frameCount; ++frame)
+			{
+				position = (static_cast<std::size_t>(frame) * hop) % positions;
+				if (prepare)
+				{
+					(this->*prepare)();
+				}
+				const Clock::time_point start{ Clock::now() };
+				(this->*work)();
+				result.nanoseconds.push_back(elapsed(start));
+			}
+			return result;
+		}
+
+		// downmix and window the samples of the current position, the loop of Sound::update()
+		void windowFrame()
+		{
+			SampleKernel::windowSamples(signal.samples.data() + position * signal.channelCount, signal.channelCount, 1.0, window, bins);
+		}
+
+		// transform the windowed samples in place
+		void transform()
+		{
+			FFT::forward(bins);
+		}
+
+		void prepareMagnitude()
+		{
+			windowFrame();
+			transform();
+		}
+
+		// convert bins to magnitudes
+		void magnitude()
+		{
+			SpectrumKernel::convert(bins.data(), fftSize / 2, rawMagnitudes, magnitudes.data());
+		}
+
+		void prepareBands()
+		{
+			prepareMagnitude();
+			magnitude();
+		}
+
+		// map magnitudes to bands and scale them to bar heights
+		void bands()
+		{
+			bandMapper.apply(magnitudes.data(), levels.data());
+			SpectrumKernel::convert(levels.data(), bandMapper.getBandCount(), barHeights, levels.data());
+		}
+
+		void prepareDraw()
+		{
+			prepareBands();
+			bands();
+		}
+
+		// stream the heights and draw them, waiting for the GPU to finish
+		void draw()
+		{
+			target.bind();
+			glClear(GL_COLOR_BUFFER_BIT);
+			spectrum->update(levels.data());
+			spectrum->draw();
+			glFinish();
+		}
+
+		// every stage of one frame
+		void chain()
+		{
+			windowFrame();
+			transform();
+			magnitude();
+			bands();
+			if (gpu)
+			{
+				draw();
+			}
+		}
+
+		const SignalGenerator::Signal &signal;
+		const int fftSize;
+		const int frameCount;
+		const bool gpu;
+		std::size_t position;
+
+		std::vector<double> window;
+		std::vector<std::complex<double>> bins;
+		std::vector<float> magnitudes;
+		std::vector<float> levels;
+		BandMapper bandMapper;
+		SpectrumKernel::Params rawMagnitudes;
+		SpectrumKernel::Params barHeights;
+		OffscreenTarget target;
+		std::unique_ptr<Spectrum> spectrum;
+	};
+
+	// write one result with min, mean and percentiles of its frame times
+	void writeResult(std::ostream &output, const Result &result)
+	{
+		std::vector<double> sorted(result.nanoseconds);
+		std::sort(sorted.begin(), sorted.end());
+		double total{ 0.0 };
+		for (double time : sorted)
+		{
+			total += time;
+		}
+		// nearest rank percentile
+		auto percentile = [&sorted](int rank)
+		{
+			return sorted[std::max<std::size_t>((sorted.size() * rank + 99) / 100, 1) - 1];
+		};
+
+		output << "    { \"stage\": \"" << result.stage << "\", \"signal\": \"" << result.signal << "\", \"frames\": " << sorted.size()
+			<< ", \"ns_per_frame\": { \"min\": " << sorted.front() << ", \"mean\": " << total / sorted.size()
+			<< ", \"p50\": " << percentile(50) << ", \"p90\": " << percentile(90) << ", \"p99\": " << percentile(99)
+			<< ", \"max\": " << sorted.back() << " }, \"throughput\": { \"value\": " << (total > 0.0 ? result.units / total * 1e9 : 0.0)
+			<< ", \"unit\": \"" << result.unit << "\" } }";
+	}
+
+	// write every result as one JSON document
+	void writeJson(std::ostream &output, const Options &options, const std::string &renderer, const std::vector<Result> &results,
+		const std::vector<DecodeTiming> &decodeTimings)
+	{
+		output << std::fixed << std::setprecision(1);
+		output << "{\n  \"fft_size\": " << options.fftSize << ",\n  \"frames\": " << options.frames
+			<< ",\n  \"display_rate\": " << s_displayRate << ",\n  \"renderer\": ";
+		if (renderer.empty())
+		{
+			output << "null";
+		}
+		else
+		{
+			output << '"' << renderer << '"';
+		}
+		output << ",\n  \"results\": [\n";
+		for (std::size_t x{ 0 }; x < results.size(); ++x)
+		{
+			writeResult(output, results[x]);
+			output << (x + 1 < results.size() ? ",\n" : "\n");
+		}
+
+		// load time against thread count, speedup is relative to one thread of the same file
+		output << "  ],\n  \"decode_threads\": [\n";
+		double singleThread{ 0.0 };
+		for (std::size_t x{ 0 }; x < decodeTimings.size(); ++x)
+		{
+			const DecodeTiming &timing{ decodeTimings[x] };
+			if (timing.threads == 1)
+			{
+				singleThread = timing.milliseconds;
+			}
+			output << "    { \"file\": \"" << timing.file << "\", \"threads\": " << timing.threads << ", \"load_ms\": " << timing.milliseconds
+				<< ", \"speedup\": " << std::setprecision(2) << singleThread / timing.milliseconds << std::setprecision(1) << " }"
+				<< (x + 1 < decodeTimings.size() ? ",\n" : "\n");
+		}
+		output << "  ]\n}\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!parseArguments(argc, argv, options))
+	{
+		return 1;
+	}
+
+	// the GPU stages need a current context with functions loaded
+#ifdef AUDIO_SPECTRUM_HEADLESS
+	EglContext context;
+	bool gpu{ options.gpu && context.create(3, 3) };
+#else
+	std::unique_ptr<sf::Context> context;
+	bool gpu{ false };
+	if (options.gpu)
+	{
+		sf::ContextSettings settings;
+		settings.majorVersion = 3;
+		settings.minorVersion = 3;
+		settings.attributeFlags = sf::ContextSettings::Core;
+		context.reset(new sf::Context(settings, Window::width, Window::height));
+		gpu = gladLoadGL() != 0;
+	}
+#endif
+	std::string renderer;
+	if (gpu)
+	{
+		renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	else if (options.gpu)
+	{
+		std::cerr << "No OpenGL context, skipping the upload+draw stage\n";
+	}
+
+	std::vector<SignalGenerator::Signal> signals;
+	signals.push_back(SignalGenerator::sines(s_syntheticSeconds, 44100));
+	signals.push_back(SignalGenerator::sweep(s_syntheticSeconds, 44100));
+	signals.push_back(SignalGenerator::noise(s_syntheticSeconds, 44100));
+
+	// bundled files are decoded first, their decode time is a stage of its own
+	std::vector<Result> results;
+	std::vector<DecodeTiming> decodeTimings;
+	for (const char* file : s_bundledFiles)
+	{
+		SignalGenerator::Signal signal;
+		signal.name = file;
+		Result result;
+		result.stage = "decode";
+		result.signal = file;
+		if (decode(options.audioDirectory + "/" + file, signal, result))
+		{
+			std::cerr << "Decoding " << file << " on every thread count\n";
+			sweepDecodeThreads(options.audioDirectory + "/" + file, file, decodeTimings);
+			results.push_back(result);
+			signals.push_back(std::move(signal));
+		}
+		else
+		{
+			std::cerr << "Unable to decode " << options.audioDirectory << "/" << file << ", skipping it\n";
+		}
+	}
+
+	for (const auto &signal : signals)
+	{
+		std::cerr << "Running " << signal.name << "\n";
+		Pipeline pipeline(options, signal, gpu);
+		if (!pipeline.create())
+		{
+			return 1;
+		}
+		pipeline.run(results);
+	}
+
+	if (options.outputPath.empty())
+	{
+		writeJson(std::cout, options, renderer, results, decodeTimings);
+		return 0;
+	}
+	std::ofstream output(options.outputPath);
+	if (!output)
+	{
+		std::cerr << "Unable to write " << options.outputPath << "\n";
+		return 1;
+	}
+	writeJson(output, options, renderer, results, decodeTimings);
+	return 0;
+}
@@ -0,0 +1,395 @@
+#define _USE_MATH_DEFINES
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef AUDIO_SPECTRUM_FFTW
+#include <fftw3.h>
+#endif
+
+#include "../fft.h"
+
+/*
+	Checks every variant of FFT::forward() and FFT::inverse() against a
+	naive DFT computed in long double, on random, impulse and sinusoid
+	inputs of every power of 2 size, then times the same variants:
+
+		fft_harness [--max-size n] [--time-size n] [--no-timing]
+
+	Errors are relative to the RMS of the expected output, so they read
+	the same at every size. Round trip errors run forward (scaled) and
+	inverse (unscaled) like Sound and MultirateAnalyzer do. Built with
+	AUDIO_SPECTRUM_FFTW and linked against FFTW 3, FFTW plans are checked
+	and timed next to the repo's kernels as a reference point.
+
+	Returns 1 when any error exceeds its tolerance.
+*/
+
+namespace
+{
+	typedef std::vector<std::complex<double>> Data;
+	typedef std::chrono::steady_clock Clock;
+
+	// a transform from input to output, returning false on failure
+	typedef std::function<bool(const Data&, Data&)> Kernel;
+
+	struct Variant
+	{
+		std::string name;
+		Kernel kernel;
+		bool inverse;		// direction of the transform
+		bool scaled;		// whether the output is scaled by 1/N
+	};
+
+	struct Options
+	{
+		int maxSize;		// largest size checked against the reference
+		int timeSize;		// largest size timed
+		bool timing;
+	};
+
+	// largest accepted relative errors, ten times the worst seen at 16384
+	const double s_maxError{ 1e-12 };
+	const double s_rmsError{ 1e-13 };
+
+	// minimum time spent timing one variant at one size
+	const double s_minimumSeconds{ 0.05 };
+
+	// parse the command line, returns false on unknown arguments
+	bool parseArguments(int argc, char* argv[], Options &optionsOut)
+	{
+		optionsOut.maxSize = 16384;
+		optionsOut.timeSize = 65536;
+		optionsOut.timing = true;
+		for (int arg{ 1 }; arg < argc; ++arg)
+		{
+			if (std::strcmp(argv[arg], "--max-size") == 0 && arg + 1 < argc)
+			{
+				optionsOut.maxSize = std::atoi(argv[++arg]);
+			}
+			else if (std::strcmp(argv[arg], "--time-size") == 0 && arg + 1 < argc)
+			{
+				optionsOut.timeSize = std::atoi(argv[++arg]);
+			}
+			else if (std::strcmp(argv[arg], "--no-timing") == 0)
+			{
+				optionsOut.timing = false;
+			}
+			else
+			{
+				std::cerr << "Unknown argument " << argv[arg] << "\n"
+					<< "Usage: " << argv[0] << " [--max-size n] [--time-size n] [--no-timing]\n";
+				return false;
+			}
+		}
+		return optionsOut.maxSize >= 2 && optionsOut.timeSize >= 2;
+	}
+
+	// uniform complex noise in [-1, 1] from a fixed seed, xorshift32
+	Data randomInput(int size)
+	{
+		Data data(size);
+		std::uint32_t state{ 0x2545F491u };
+		auto next = [&state]()
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return static_cast<double>(state) / 4294967295.0 * 2.0 - 1.0;
+		};
+		for (auto &element : data)
+		{
+			const double real{ next() };
+			element = { real, next() };
+		}
+		return data;
+	}
+
+	// a unit impulse one sample in, so every output has a different phase
+	Data impulseInput(int size)
+	{
+		Data data(size);
+		data[1] = 1.0;
+		return data;
+	}
+
+	// a real sine between bins plus a cosine on a bin, as in music
+	Data sinusoidInput(int size)
+	{
+		Data data(size);
+		for (int x{ 0 }; x < size; ++x)
+		{
+			const double phase{ 2.0 * M_PI * x / size };
+			data[x] = 0.75 * std::sin(phase * size * 0.1234) + 0.25 * std::cos(phase * (size / 4));
+		}
+		return data;
+	}
+
+	// naive DFT in long double with exactly computed twiddles, unscaled
+	Data reference(const Data &input, bool inverse)
+	{
+		const std::size_t size{ input.size() };
+		const long double pi{ 3.141592653589793238462643383279502884L };
+		const long double sign{ inverse ? 1.0L : -1.0L };
+		std::vector<long double> cosines(size);
+		std::vector<long double> sines(size);
+		for (std::size_t x{ 0 }; x < size; ++x)
+		{
+			const long double angle{ 2.0L * pi * x / size };
+			cosines[x] = std::cos(angle);
+			sines[x] = sign * std::sin(angle);
+		}
+
+		Data output(size);
+		for (std::size_t bin{ 0 }; bin < size; ++bin)
+		{
+			long double real{ 0.0L };
+			long double imag{ 0.0L };
+			for (std::size_t x{ 0 }; x < size; ++x)
+			{
+				// size is a power of 2, so the twiddle index wraps with a mask
+				const std::size_t twiddle{ (bin * x) & (size - 1) };
+				const long double inReal{ input[x].real() };
+				const long double inImag{ input[x].imag() };
+				real += inReal * cosines[twiddle] - inImag * sines[twiddle];
+				imag += inReal * sines[twiddle] + inImag * cosines[twiddle];
+			}
+			output[bin] = { static_cast<double>(real), static_cast<double>(imag) };
+		}
+		return output;
+	}
+
+	// maximum and RMS of the difference, relative to the RMS of expected
+	void compare(const Data &actual, const Data &expected, double &maxOut, double &rmsOut)
+	{
+		long double errorSum{ 0.0L };
+		long double expectedSum{ 0.0L };
+		double maxError{ 0.0 };
+		for (std::size_t x{ 0 }; x < actual.size(); ++x)
+		{
+			const double error{ std::abs(actual[x] - expected[x]) };
+			maxError = std::max(maxError, error);
+			errorSum += static_cast<long double>(error) * error;
+			expectedSum += static_cast<long double>(std::norm(expected[x]));
+		}
+		const double expectedRms{ static_cast<double>(std::sqrt(expectedSum / actual.size())) };
+		maxOut = maxError / expectedRms;
+		rmsOut = static_cast<double>(std::sqrt(errorSum / actual.size())) / expectedRms;
+	}
+
+#ifdef AUDIO_SPECTRUM_FFTW
+	/*
+		An FFTW plan of one size and direction, executed on copies of the
+		input so planning with FFTW_MEASURE never touches caller data.
+	*/
+	class FftwPlan
+	{
+	public:
+		FftwPlan(int size, bool inverse)
+			: input(size), output(size)
+		{
+			plan = fftw_plan_dft_1d(size, reinterpret_cast<fftw_complex*>(input.data()), reinterpret_cast<fftw_complex*>(output.data()),
+				inverse ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_MEASURE);
+		}
+
+		~FftwPlan()
+		{
+			fftw_destroy_plan(plan);
+		}
+
+		FftwPlan(const FftwPlan&) = delete;
+		FftwPlan& operator=(const FftwPlan&) = delete;
+
+		// transform a copy of samples into dataOut, unscaled like FFTW itself
+		bool execute(const Data &samples, Data &dataOut)
+		{
+			if (samples.size() != input.size() || dataOut.size() != output.size())
+			{
+				std::cerr << "FftwPlan::execute(): invalid vector length\n";
+				return false;
+			}
+			std::copy(samples.begin(), samples.end(), input.begin());
+			fftw_execute(plan);
+			std::copy(output.begin(), output.end(), dataOut.begin());
+			return true;
+		}
+
+	private:
+		Data input;
+		Data output;
+		fftw_plan plan;
+	};
+#endif
+
+	// every variant of the repo's kernels, plus FFTW when built with it
+	std::vector<Variant> makeVariants(int size)
+	{
+		// only FFTW plans depend on the size
+		static_cast<void>(size);
+		std::vector<Variant> variants;
+		for (bool scaled : { true, false })
+		{
+			const std::string suffix{ scaled ? " scaled" : "" };
+			variants.push_back({ "forward" + suffix, [scaled](const Data &in, Data &out)
+			{
+				return FFT::forward(in, out, scaled);
+			}, false, scaled });
+			variants.push_back({ "forward in place" + suffix, [scaled](const Data &in, Data &out)
+			{
+				std::copy(in.begin(), in.end(), out.begin());
+				return FFT::forward(out, scaled);
+			}, false, scaled });
+			variants.push_back({ "inverse" + suffix, [scaled](const Data &in, Data &out)
+			{
+				return FFT::inverse(in, out, scaled);
+			}, true, scaled });
+			variants.push_back({ "inverse in place" + suffix, [scaled](const Data &in, Data &out)
+			{
+				std::copy(in.begin(), in.end(), out.begin());
+				return FFT::inverse(out, scaled);
+			}, true, scaled });
+		}
+#ifdef AUDIO_SPECTRUM_FFTW
+		for (bool inverse : { false, true })
+		{
+			std::shared_ptr<FftwPlan> plan{ std::make_shared<FftwPlan>(size, inverse) };
+			variants.push_back({ inverse ? "fftw inverse" : "fftw forward", [plan](const Data &in, Data &out)
+			{
+				return plan->execute(in, out);
+			}, inverse, false });
+		}
+#endif
+		return variants;
+	}
+
+	// print one line of the accuracy table, returns false above tolerance
+	bool report(int size, const char* input, const std::string &check, double maxError, double rmsError)
+	{
+		const bool passed{ maxError <= s_maxError && rmsError <= s_rmsError };
+		std::cout << std::setw(6) << size << "  " << std::left << std::setw(10) << input << std::setw(26) << check << std::right
+			<< std::setw(12) << maxError << std::setw(12) << rmsError << (passed ? "" : "  FAIL") << "\n";
+		return passed;
+	}
+
+	// check every variant and both round trips at one size
+	bool checkSize(int size)
+	{
+		bool passed{ true };
+		const std::vector<Variant> variants{ makeVariants(size) };
+		const std::pair<const char*, Data> inputs[]{
+			{ "random", randomInput(size) },
+			{ "impulse", impulseInput(size) },
+			{ "sinusoid", sinusoidInput(size) } };
+		for (const auto &input : inputs)
+		{
+			const Data expected[]{ reference(input.second, false), reference(input.second, true) };
+			for (const auto &variant : variants)
+			{
+				Data scaledExpected(expected[variant.inverse]);
+				if (variant.scaled)
+				{
+					for (auto &element : scaledExpected)
+					{
+						element /= size;
+					}
+				}
+				Data output(size);
+				if (!variant.kernel(input.second, output))
+				{
+					std::cerr << variant.name << " failed at size " << size << "\n";
+					passed = false;
+					continue;
+				}
+				double maxError;
+				double rmsError;
+				compare(output, scaledExpected, maxError, rmsError);
+				passed = report(size, input.first, variant.name, maxError, rmsError) && passed;
+			}
+
+			// forward then inverse, out of place and in place
+			Data spectrum(size);
+			Data roundTrip(size);
+			FFT::forward(input.second, spectrum);
+			FFT::inverse(spectrum, roundTrip);
+			double maxError;
+			double rmsError;
+			compare(roundTrip, input.second, maxError, rmsError);
+			passed = report(size, input.first, "round trip", maxError, rmsError) && passed;
+
+			roundTrip = input.second;
+			FFT::forward(roundTrip);
+			FFT::inverse(roundTrip);
+			compare(roundTrip, input.second, maxError, rmsError);
+			passed = report(size, input.first, "round trip in place", maxError, rmsError) && passed;
+		}
+		return passed;
+	}
+
+	// time every variant at one size on random input
+	void timeSize(int size)
+	{
+		const Data input{ randomInput(size) };
+		Data output(size);
+		const double flops{ 5.0 * size * std::log2(static_cast<double>(size)) };
+		for (const auto &variant : makeVariants(size))
+		{
+			// warm up, then repeat until enough time has passed
+			variant.kernel(input, output);
+			long long iterations{ 0 };
+			double seconds{ 0.0 };
+			const Clock::time_point start{ Clock::now() };
+			while (seconds < s_minimumSeconds)
+			{
+				variant.kernel(input, output);
+				++iterations;
+				seconds = std::chrono::duration<double>(Clock::now() - start).count();
+			}
+			const double nanoseconds{ seconds * 1e9 / iterations };
+			std::cout << std::setw(6) << size << "  " << std::left << std::setw(26) << variant.name << std::right
+				<< std::setw(12) << nanoseconds << std::setw(10) << flops / nanoseconds * 1e3 << "\n";
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!parseArguments(argc, argv, options))
+	{
+		return 1;
+	}
+
+	bool passed{ true };
+	std::cout << std::scientific << std::setprecision(2);
+	std::cout << "  size  input     check                        max error   rms error\n";
+	for (int size{ 2 }; size <= options.maxSize; size *= 2)
+	{
+		passed = checkSize(size) && passed;
+	}
+
+	if (options.timing)
+	{
+		std::cout << std::fixed << std::setprecision(0);
+		std::cout << "\n  size  variant                      ns/call    mflops\n";
+		for (int size{ 16 }; size <= options.timeSize; size *= 4)
+		{
+			timeSize(size);
+		}
+	}
+
+#ifdef AUDIO_SPECTRUM_FFTW
+	fftw_cleanup();
+#endif
+	std::cout << (passed ? "\nAll checks passed\n" : "\nSome checks FAILED\n");
+	return passed ? 0 : 1;
+}
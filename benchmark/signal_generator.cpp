@@ -0,0 +1,81 @@
+#define _USE_MATH_DEFINES
+
+#include "signal_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+	// peak amplitude of generated signals, half of full scale
+	const double s_amplitude{ 0.5 * 32767.0 };
+
+	// an empty stereo signal of the given length
+	SignalGenerator::Signal makeSignal(const std::string &name, double seconds, int sampleRate)
+	{
+		SignalGenerator::Signal signal;
+		signal.name = name;
+		signal.channelCount = 2;
+		signal.sampleRate = sampleRate;
+		signal.samples.resize(static_cast<std::size_t>(seconds * sampleRate) * signal.channelCount);
+		return signal;
+	}
+}
+
+namespace SignalGenerator
+{
+	// a chord of 110 Hz, 440 Hz and 3520 Hz sines in both channels
+	Signal sines(double seconds, int sampleRate)
+	{
+		Signal signal{ makeSignal("sines", seconds, sampleRate) };
+		const double frequencies[]{ 110.0, 440.0, 3520.0 };
+		for (std::size_t frame{ 0 }; frame < signal.samples.size() / 2; ++frame)
+		{
+			double value{ 0.0 };
+			for (double frequency : frequencies)
+			{
+				value += std::sin(2.0 * M_PI * frequency * frame / sampleRate);
+			}
+			const sf::Int16 sample{ static_cast<sf::Int16>(value * s_amplitude / 3.0) };
+			signal.samples[2 * frame] = sample;
+			signal.samples[2 * frame + 1] = sample;
+		}
+		return signal;
+	}
+
+	// a logarithmic sweep from 20 Hz to 20 kHz
+	Signal sweep(double seconds, int sampleRate)
+	{
+		Signal signal{ makeSignal("sweep", seconds, sampleRate) };
+		const double low{ 20.0 };
+		const double high{ std::min(20000.0, sampleRate / 2.0) };
+		const double rate{ std::log(high / low) / seconds };
+		for (std::size_t frame{ 0 }; frame < signal.samples.size() / 2; ++frame)
+		{
+			// phase is the integral of low * e^(rate * t)
+			const double time{ static_cast<double>(frame) / sampleRate };
+			const double phase{ 2.0 * M_PI * low * (std::exp(rate * time) - 1.0) / rate };
+			const sf::Int16 sample{ static_cast<sf::Int16>(std::sin(phase) * s_amplitude) };
+			signal.samples[2 * frame] = sample;
+			signal.samples[2 * frame + 1] = sample;
+		}
+		return signal;
+	}
+
+	// white noise from a fixed seed, different in each channel
+	Signal noise(double seconds, int sampleRate)
+	{
+		Signal signal{ makeSignal("noise", seconds, sampleRate) };
+		std::uint32_t state{ 0x12345678u };
+		for (auto &sample : signal.samples)
+		{
+			// xorshift32, the same sequence on every platform
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			sample = static_cast<sf::Int16>((static_cast<double>(state) / 4294967295.0 * 2.0 - 1.0) * s_amplitude);
+		}
+		return signal;
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef SIGNAL_GENERATOR_H
+#define SIGNAL_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <SFML/System.hpp>
+
+/*
+	Synthetic test signals for the benchmark, generated as interleaved
+	16-bit stereo like decoded audio files. Every signal is deterministic,
+	so runs on different machines analyze exactly the same samples.
+*/
+namespace SignalGenerator
+{
+	struct Signal
+	{
+		std::string name;
+		std::vector<sf::Int16> samples;		// interleaved samples
+		int channelCount;
+		int sampleRate;
+	};
+
+	// a chord of 110 Hz, 440 Hz and 3520 Hz sines in both channels
+	Signal sines(double seconds, int sampleRate);
+
+	// a logarithmic sweep from 20 Hz to 20 kHz, like audio/slide.ogg
+	Signal sweep(double seconds, int sampleRate);
+
+	// white noise from a fixed seed, different in each channel
+	Signal noise(double seconds, int sampleRate);
+}
+
+#endif
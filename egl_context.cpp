@@ -0,0 +1,110 @@
+#include "egl_context.h"
+
+#include <iostream>
+#include <glad/glad.h>
+
+#ifdef AUDIO_SPECTRUM_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace
+{
+	// OpenGL function loader for glad
+	void* getProcAddress(const char* name)
+	{
+		return reinterpret_cast<void*>(eglGetProcAddress(name));
+	}
+}
+#endif
+
+// default constructor
+EglContext::EglContext() : display{ nullptr }, context{ nullptr }
+{
+}
+
+// destructor, release the context and display
+EglContext::~EglContext()
+{
+	destroy();
+}
+
+// creates a core profile context, makes it current and loads OpenGL functions
+bool EglContext::create(int majorVersion, int minorVersion)
+{
+#ifdef AUDIO_SPECTRUM_HEADLESS
+	destroy();
+
+	// prefer the surfaceless platform, it needs neither a display server nor a GPU
+	EGLDisplay eglDisplay{ EGL_NO_DISPLAY };
+	const auto getPlatformDisplay{ reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT")) };
+	if (getPlatformDisplay)
+	{
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (eglDisplay == EGL_NO_DISPLAY)
+	{
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major, minor;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+	{
+		std::cerr << "EglContext::create(): unable to initialize an EGL display\n";
+		return false;
+	}
+	display = eglDisplay;
+
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cerr << "EglContext::create(): desktop OpenGL is not supported\n";
+		destroy();
+		return false;
+	}
+
+	// rendering only goes to framebuffer objects, so no config or surface is needed
+	const EGLint attributes[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+		EGL_CONTEXT_MINOR_VERSION, minorVersion,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	context = eglCreateContext(eglDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+	if (!context)
+	{
+		std::cerr << "EglContext::create(): unable to create an OpenGL " << majorVersion << "." << minorVersion
+			<< " context (error 0x" << std::hex << eglGetError() << std::dec << ")\n";
+		destroy();
+		return false;
+	}
+
+	if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context) || !gladLoadGLLoader(getProcAddress))
+	{
+		std::cerr << "EglContext::create(): unable to make the context current\n";
+		destroy();
+		return false;
+	}
+	return true;
+#else
+	std::cerr << "EglContext::create(): built without AUDIO_SPECTRUM_HEADLESS\n";
+	return false;
+#endif
+}
+
+// release the context and display
+void EglContext::destroy()
+{
+#ifdef AUDIO_SPECTRUM_HEADLESS
+	if (display)
+	{
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (context)
+		{
+			eglDestroyContext(display, context);
+		}
+		eglTerminate(display);
+	}
+#endif
+	display = nullptr;
+	context = nullptr;
+}
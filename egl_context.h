@@ -0,0 +1,38 @@
+#ifndef EGL_CONTEXT_H
+#define EGL_CONTEXT_H
+
+/*
+	OpenGL context without a window or display server, for rendering into
+	framebuffer objects on machines without a GPU. Uses EGL on the Mesa
+	surfaceless platform, which falls back to the llvmpipe software
+	rasterizer. Only available when built with AUDIO_SPECTRUM_HEADLESS
+	(and linked against libEGL); otherwise create() always fails.
+*/
+class EglContext
+{
+public:
+	// default constructor
+	EglContext();
+
+	// destructor, release the context and display
+	~EglContext();
+
+	EglContext(const EglContext &) = delete;
+	EglContext &operator=(const EglContext &) = delete;
+
+	/*
+		Creates a core profile context of the given version, makes it
+		current on the calling thread and loads OpenGL functions.
+
+		Returns true on success and false on failure.
+	*/
+	bool create(int majorVersion, int minorVersion);
+
+	void destroy();				// release the context and display
+
+private:
+	void* display;
+	void* context;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include "frame_arena.h"
+
+#include <cstdint>
+
+// reserve capacity bytes up front
+FrameArena::FrameArena(std::size_t capacity)
+	: block{ new unsigned char[capacity] }, capacity{ capacity }, used{ 0 }, overflowBytes{ 0 }
+{
+}
+
+// release every allocation, growing the block after an overflow
+void FrameArena::reset()
+{
+	if (!overflow.empty())
+	{
+		// room for the whole peak frame, with slack for alignment padding
+		capacity = used + overflowBytes + overflow.size() * alignof(std::max_align_t);
+		block.reset(new unsigned char[capacity]);
+		overflow.clear();
+		overflowBytes = 0;
+	}
+	used = 0;
+}
+
+// retrieve the bytes allocated since the last reset
+std::size_t FrameArena::getUsed() const
+{
+	return used + overflowBytes;
+}
+
+// retrieve the size of the main block in bytes
+std::size_t FrameArena::getCapacity() const
+{
+	return capacity;
+}
+
+// align and bump, or fall back to an overflow block
+void* FrameArena::allocateBytes(std::size_t size, std::size_t alignment)
+{
+	const std::uintptr_t address{ reinterpret_cast<std::uintptr_t>(block.get()) + used };
+	const std::size_t padding{ (alignment - address % alignment) % alignment };
+	if (used + padding + size <= capacity)
+	{
+		used += padding + size;
+		return block.get() + used - size;
+	}
+
+	// new[] memory is aligned for any fundamental type
+	overflow.emplace_back(new unsigned char[size]);
+	overflowBytes += size;
+	return overflow.back().get();
+}
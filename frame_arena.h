@@ -0,0 +1,51 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+	Bump allocator for scratch data that only lives for one frame, like
+	magnitudes and band levels. Allocating moves a pointer through one
+	block and reset() at the start of the next frame releases everything
+	at once, so steady state frames never touch the heap.
+
+	A frame that needs more than the block falls back to separate heap
+	blocks; the next reset() grows the main block to that frame's total,
+	so the overflow happens at most once per new peak.
+*/
+class FrameArena
+{
+public:
+	// reserve capacity bytes up front
+	explicit FrameArena(std::size_t capacity = 1 << 16);
+
+	FrameArena(const FrameArena &) = delete;
+	FrameArena &operator=(const FrameArena &) = delete;
+
+	// retrieve uninitialized room for count objects, valid until the next reset()
+	template <typename T>
+	T* allocate(std::size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+		return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+	}
+
+	void reset();						// release every allocation, growing the block after an overflow
+	std::size_t getUsed() const;		// retrieve the bytes allocated since the last reset
+	std::size_t getCapacity() const;	// retrieve the size of the main block in bytes
+
+private:
+	// align and bump, or fall back to an overflow block
+	void* allocateBytes(std::size_t size, std::size_t alignment);
+
+	std::unique_ptr<unsigned char[]> block;
+	std::size_t capacity;
+	std::size_t used;
+	std::size_t overflowBytes;			// bytes of this frame that did not fit the block
+	std::vector<std::unique_ptr<unsigned char[]>> overflow;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <thread>
+#include <SFML/System.hpp>
+
+const FramePacer::Clock::duration FramePacer::s_spinTime{ std::chrono::milliseconds(2) };
+
+// starts in vsync mode, capping at framesPerSecond when switched to Capped
+FramePacer::FramePacer(sf::Window &window, int framesPerSecond) : window(window), mode{ Uncapped }
+{
+	setFramesPerSecond(framesPerSecond);
+	setMode(Vsync);
+}
+
+// switch pacing mode
+void FramePacer::setMode(Mode mode)
+{
+	this->mode = mode;
+	window.setVerticalSyncEnabled(mode == Vsync);
+	deadline = Clock::now();
+}
+
+// set the rate of the capped mode
+void FramePacer::setFramesPerSecond(int framesPerSecond)
+{
+	this->framesPerSecond = std::max(framesPerSecond, 1);
+	period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / this->framesPerSecond));
+}
+
+// retrieve the pacing mode
+FramePacer::Mode FramePacer::getMode() const
+{
+	return mode;
+}
+
+// retrieve the rate of the capped mode
+int FramePacer::getFramesPerSecond() const
+{
+	return framesPerSecond;
+}
+
+// wait until the next frame is due
+void FramePacer::wait()
+{
+	if (mode != Capped)
+	{
+		return;
+	}
+
+	deadline += period;
+	const Clock::time_point now{ Clock::now() };
+	if (deadline < now)
+	{
+		// more than a frame late (stall, seek, window drag), restart the schedule
+		// rather than presenting a burst of frames to catch up
+		if (now - deadline > period)
+		{
+			deadline = now;
+		}
+		return;
+	}
+
+	// sf::sleep raises the timer resolution on Windows, sleeping in whole
+	// milliseconds is accurate to about one tick
+	const Clock::duration sleepTime{ deadline - now - s_spinTime };
+	if (sleepTime > Clock::duration::zero())
+	{
+		sf::sleep(sf::microseconds(static_cast<sf::Int64>(std::chrono::duration_cast<std::chrono::microseconds>(sleepTime).count())));
+	}
+	while (Clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+}
+
+// retrieve a readable name of a mode
+const char* FramePacer::getModeName(Mode mode)
+{
+	switch (mode)
+	{
+	case Vsync:
+		return "vsync";
+	case Capped:
+		return "capped";
+	default:
+		return "uncapped";
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+#include <SFML/Window.hpp>
+
+/*
+	Controls how often the main loop presents a frame. Vsync leaves
+	pacing to the driver's swap interval; the cap waits for absolute
+	deadlines one frame period apart, so sleep overshoot in one frame is
+	taken out of the next instead of accumulating as drift.
+*/
+class FramePacer
+{
+public:
+	enum Mode
+	{
+		Vsync,		// wait for vertical blank in display()
+		Capped,		// sleep up to a fixed frames per second
+		Uncapped	// present as fast as possible
+	};
+
+	// starts in vsync mode, capping at framesPerSecond when switched to Capped
+	FramePacer(sf::Window &window, int framesPerSecond = 60);
+
+	void setMode(Mode mode);					// switch pacing mode
+	void setFramesPerSecond(int framesPerSecond);	// set the rate of the capped mode
+	Mode getMode() const;						// retrieve the pacing mode
+	int getFramesPerSecond() const;				// retrieve the rate of the capped mode
+
+	// wait until the next frame is due, call once per frame before display()
+	void wait();
+
+	// retrieve a readable name of a mode
+	static const char* getModeName(Mode mode);
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// the final part of a wait is spun, since sleeps overshoot by up to a timer tick
+	static const Clock::duration s_spinTime;
+
+	sf::Window &window;
+	Mode mode;
+	int framesPerSecond;
+	Clock::duration period;
+	Clock::time_point deadline;
+};
+
+#endif
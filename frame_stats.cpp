@@ -0,0 +1,113 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <utility>
+
+// keep the last windowSize samples of every section
+FrameStats::FrameStats(int windowSize) : windowSize{ static_cast<std::size_t>(std::max(windowSize, 1)) }
+{
+}
+
+// add a section and retrieve its id
+int FrameStats::addSection(const std::string &name)
+{
+	Section section;
+	section.name = name;
+	section.samples.reserve(windowSize);
+	section.next = 0;
+	// moved, a copy would not keep the reserved capacity
+	sections.push_back(std::move(section));
+	return static_cast<int>(sections.size()) - 1;
+}
+
+// add a sample to a section
+void FrameStats::record(int section, double milliseconds)
+{
+	Section &target{ sections[section] };
+	if (target.samples.size() < windowSize)
+	{
+		target.samples.push_back(milliseconds);
+	}
+	else
+	{
+		target.samples[target.next] = milliseconds;
+	}
+	target.next = (target.next + 1) % windowSize;
+}
+
+// retrieve min/avg/p99 of a section's window
+FrameStats::Summary FrameStats::getSummary(int section) const
+{
+	Summary summary{ 0.0, 0.0, 0.0, 0 };
+	const std::vector<double> &samples{ sections[section].samples };
+	if (samples.empty())
+	{
+		return summary;
+	}
+
+	summary.count = static_cast<int>(samples.size());
+	summary.min = *std::min_element(samples.begin(), samples.end());
+	summary.average = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+	// nearest rank percentile
+	std::vector<double> sorted(samples);
+	const std::size_t rank{ (sorted.size() * 99 + 99) / 100 - 1 };
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+	summary.p99 = sorted[rank];
+	return summary;
+}
+
+// retrieve the newest sample of a section, 0 if none
+double FrameStats::getLatest(int section) const
+{
+	const Section &source{ sections[section] };
+	if (source.samples.empty())
+	{
+		return 0.0;
+	}
+	return source.samples[(source.next + windowSize - 1) % windowSize];
+}
+
+// retrieve the name of a section
+const std::string &FrameStats::getName(int section) const
+{
+	return sections[section].name;
+}
+
+// retrieve the amount of sections
+int FrameStats::getSectionCount() const
+{
+	return static_cast<int>(sections.size());
+}
+
+// write one line of min/avg/p99 per section
+void FrameStats::print(std::ostream &output) const
+{
+	const std::ios::fmtflags flags{ output.flags() };
+	const std::streamsize precision{ output.precision() };
+	output << std::fixed << std::setprecision(3);
+	for (int section{ 0 }; section < getSectionCount(); ++section)
+	{
+		const Summary summary{ getSummary(section) };
+		output << std::left << std::setw(16) << sections[section].name << std::right
+			<< " min " << std::setw(8) << summary.min
+			<< "  avg " << std::setw(8) << summary.average
+			<< "  p99 " << std::setw(8) << summary.p99 << " ms\n";
+	}
+	output.flags(flags);
+	output.precision(precision);
+}
+
+// start timing a section
+ScopedTimer::ScopedTimer(FrameStats &stats, int section)
+	: stats(stats), section{ section }, start{ std::chrono::steady_clock::now() }
+{
+}
+
+// stop timing and record the elapsed time
+ScopedTimer::~ScopedTimer()
+{
+	stats.record(section, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
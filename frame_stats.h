@@ -0,0 +1,72 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+	Rolling timing statistics of named frame sections. Every section keeps
+	the last windowSize samples in milliseconds and reports their minimum,
+	average and 99th percentile.
+*/
+class FrameStats
+{
+public:
+	struct Summary
+	{
+		double min;
+		double average;
+		double p99;
+		int count;			// amount of samples in the window
+	};
+
+	// keep the last windowSize samples of every section
+	explicit FrameStats(int windowSize = 240);
+
+	int addSection(const std::string &name);			// add a section and retrieve its id
+	void record(int section, double milliseconds);		// add a sample to a section
+	Summary getSummary(int section) const;				// retrieve min/avg/p99 of a section's window
+	double getLatest(int section) const;				// retrieve the newest sample of a section, 0 if none
+	const std::string &getName(int section) const;		// retrieve the name of a section
+	int getSectionCount() const;						// retrieve the amount of sections
+
+	// write one line of min/avg/p99 per section
+	void print(std::ostream &output) const;
+
+private:
+	struct Section
+	{
+		std::string name;
+		std::vector<double> samples;	// ring of the last windowSize samples
+		std::size_t next;				// ring position of the next sample
+	};
+
+	const std::size_t windowSize;
+	std::vector<Section> sections;
+};
+
+/*
+	Records the wall time between construction and destruction into a
+	section of a FrameStats.
+*/
+class ScopedTimer
+{
+public:
+	// start timing a section
+	ScopedTimer(FrameStats &stats, int section);
+
+	// stop timing and record the elapsed time
+	~ScopedTimer();
+
+	ScopedTimer(const ScopedTimer &) = delete;
+	ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+	FrameStats &stats;
+	const int section;
+	const std::chrono::steady_clock::time_point start;
+};
+
+#endif
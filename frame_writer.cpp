@@ -0,0 +1,288 @@
+#include "frame_writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+	// largest payload of an uncompressed deflate block
+	const std::size_t s_storedBlockSize{ 65535 };
+
+	// bytes that can be added to adler-32 sums before they must be reduced
+	const std::size_t s_adlerRun{ 5552 };
+
+	// lookup tables of CRC-32 (reflected polynomial 0xEDB88320), table[k]
+	// advances a byte followed by k zero bytes, for eight bytes per step
+	struct CrcTables
+	{
+		CrcTables()
+		{
+			for (std::uint32_t n{ 0 }; n < 256; ++n)
+			{
+				std::uint32_t c{ n };
+				for (int k{ 0 }; k < 8; ++k)
+				{
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				}
+				table[0][n] = c;
+			}
+			for (std::uint32_t n{ 0 }; n < 256; ++n)
+			{
+				for (int k{ 1 }; k < 8; ++k)
+				{
+					table[k][n] = table[0][table[k - 1][n] & 0xFF] ^ (table[k - 1][n] >> 8);
+				}
+			}
+		}
+
+		std::uint32_t table[8][256];
+	};
+
+	// CRC-32 of PNG chunks
+	std::uint32_t crc32(const unsigned char* data, std::size_t length)
+	{
+		static const CrcTables tables;
+		const auto &table = tables.table;
+
+		std::uint32_t crc{ 0xFFFFFFFFu };
+		std::size_t x{ 0 };
+		for (; x + 8 <= length; x += 8)
+		{
+			const std::uint32_t low{ crc ^ (data[x] | data[x + 1] << 8 | data[x + 2] << 16 | static_cast<std::uint32_t>(data[x + 3]) << 24) };
+			crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+				table[3][data[x + 4]] ^ table[2][data[x + 5]] ^ table[1][data[x + 6]] ^ table[0][data[x + 7]];
+		}
+		for (; x < length; ++x)
+		{
+			crc = table[0][(crc ^ data[x]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	// write a 32-bit big endian value
+	void writeBigEndian(unsigned char* data, std::uint32_t value)
+	{
+		data[0] = static_cast<unsigned char>(value >> 24);
+		data[1] = static_cast<unsigned char>(value >> 16);
+		data[2] = static_cast<unsigned char>(value >> 8);
+		data[3] = static_cast<unsigned char>(value);
+	}
+
+	// append a PNG chunk header: data length and type
+	void beginChunk(std::vector<unsigned char> &file, const char* type, std::size_t length)
+	{
+		const std::size_t start{ file.size() };
+		file.resize(start + 4);
+		writeBigEndian(file.data() + start, static_cast<std::uint32_t>(length));
+		file.insert(file.end(), type, type + 4);
+	}
+
+	// append the CRC of the type and data of a chunk ending the file
+	void endChunk(std::vector<unsigned char> &file, std::size_t length)
+	{
+		const std::size_t typeStart{ file.size() - length - 4 };
+		const std::uint32_t crc{ crc32(file.data() + typeStart, length + 4) };
+		file.resize(file.size() + 4);
+		writeBigEndian(file.data() + file.size() - 4, crc);
+	}
+}
+
+// default constructor
+FrameWriter::FrameWriter()
+	: format{ Raw }, width{ 0 }, height{ 0 }, frameCount{ 0 }, stream{ nullptr }, ownsStream{ false }
+{
+}
+
+// destructor, closes the raw stream
+FrameWriter::~FrameWriter()
+{
+	close();
+}
+
+// prepares writing frames of the given size
+bool FrameWriter::open(const std::string &path, Format format, int width, int height)
+{
+	close();
+	this->path = path;
+	this->format = format;
+	this->width = width;
+	this->height = height;
+	frameCount = 0;
+
+	if (format == Raw)
+	{
+		if (path == "-")
+		{
+#ifdef _WIN32
+			_setmode(_fileno(stdout), _O_BINARY);
+#endif
+			stream = stdout;
+		}
+		else
+		{
+			stream = std::fopen(path.c_str(), "wb");
+			ownsStream = true;
+		}
+		if (!stream)
+		{
+			std::cerr << "FrameWriter::open(): unable to open " << path << "\n";
+			ownsStream = false;
+			return false;
+		}
+	}
+	return true;
+}
+
+// write one frame of width * height RGBA pixels, top row first
+bool FrameWriter::write(const std::vector<unsigned char> &pixels)
+{
+	if (pixels.size() != static_cast<std::size_t>(width) * height * 4)
+	{
+		std::cerr << "FrameWriter::write(): frame size does not match\n";
+		return false;
+	}
+
+	if (format == Raw)
+	{
+		if (!stream || std::fwrite(pixels.data(), 1, pixels.size(), stream) != pixels.size())
+		{
+			std::cerr << "FrameWriter::write(): unable to write frame " << frameCount << "\n";
+			return false;
+		}
+	}
+	else
+	{
+		char number[16];
+		std::snprintf(number, sizeof(number), "_%06d.png", frameCount);
+		if (!writePng(path + number, pixels.data(), width, height))
+		{
+			return false;
+		}
+	}
+	++frameCount;
+	return true;
+}
+
+// flush and close the raw stream
+void FrameWriter::close()
+{
+	if (stream)
+	{
+		std::fflush(stream);
+		if (ownsStream)
+		{
+			std::fclose(stream);
+		}
+	}
+	stream = nullptr;
+	ownsStream = false;
+}
+
+// retrieve the amount of frames written
+int FrameWriter::getFrameCount() const
+{
+	return frameCount;
+}
+
+// write a single RGBA image, top row first, as a PNG file
+bool FrameWriter::writePng(const std::string &path, const unsigned char* pixels, int width, int height)
+{
+	// scanlines each start with filter type 0 (none), and are stored in
+	// a zlib stream of uncompressed deflate blocks
+	const std::size_t rowSize{ static_cast<std::size_t>(width) * 4 };
+	const std::size_t dataSize{ (rowSize + 1) * height };
+	const std::size_t blockCount{ std::max<std::size_t>((dataSize + s_storedBlockSize - 1) / s_storedBlockSize, 1) };
+	const std::size_t idatSize{ 2 + blockCount * 5 + dataSize + 4 };
+
+	std::vector<unsigned char> file{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.reserve(8 + 25 + 12 + idatSize + 12);
+
+	// 8 bits per channel, RGBA, no interlacing
+	beginChunk(file, "IHDR", 13);
+	file.resize(file.size() + 8);
+	writeBigEndian(file.data() + file.size() - 8, static_cast<std::uint32_t>(width));
+	writeBigEndian(file.data() + file.size() - 4, static_cast<std::uint32_t>(height));
+	file.insert(file.end(), { 8, 6, 0, 0, 0 });
+	endChunk(file, 13);
+
+	beginChunk(file, "IDAT", idatSize);
+	file.push_back(0x78);
+	file.push_back(0x01);
+
+	// copy rows into blocks while updating the adler-32 checksum, sums
+	// stay below 2^32 for s_adlerRun bytes between reductions
+	std::uint32_t adlerA{ 1 };
+	std::uint32_t adlerB{ 0 };
+	std::size_t written{ 0 };
+	std::size_t blockLeft{ 0 };
+	std::size_t adlerLeft{ s_adlerRun };
+	auto append = [&](const unsigned char* data, std::size_t length)
+	{
+		while (length > 0)
+		{
+			if (blockLeft == 0)
+			{
+				blockLeft = std::min(s_storedBlockSize, dataSize - written);
+				const bool last{ written + blockLeft == dataSize };
+				file.insert(file.end(), {
+					static_cast<unsigned char>(last ? 1 : 0),
+					static_cast<unsigned char>(blockLeft), static_cast<unsigned char>(blockLeft >> 8),
+					static_cast<unsigned char>(~blockLeft), static_cast<unsigned char>(~blockLeft >> 8) });
+			}
+			const std::size_t count{ std::min(std::min(length, blockLeft), adlerLeft) };
+			for (std::size_t x{ 0 }; x < count; ++x)
+			{
+				adlerA += data[x];
+				adlerB += adlerA;
+			}
+			file.insert(file.end(), data, data + count);
+			adlerLeft -= count;
+			if (adlerLeft == 0)
+			{
+				adlerA %= 65521;
+				adlerB %= 65521;
+				adlerLeft = s_adlerRun;
+			}
+			data += count;
+			length -= count;
+			blockLeft -= count;
+			written += count;
+		}
+	};
+	const unsigned char filter{ 0 };
+	for (int row{ 0 }; row < height; ++row)
+	{
+		append(&filter, 1);
+		append(pixels + row * rowSize, rowSize);
+	}
+	if (dataSize == 0)
+	{
+		file.insert(file.end(), { 1, 0, 0, 0xFF, 0xFF });
+	}
+	file.resize(file.size() + 4);
+	writeBigEndian(file.data() + file.size() - 4, ((adlerB % 65521) << 16) | (adlerA % 65521));
+	endChunk(file, idatSize);
+
+	beginChunk(file, "IEND", 0);
+	endChunk(file, 0);
+
+	std::FILE* output{ std::fopen(path.c_str(), "wb") };
+	if (!output)
+	{
+		std::cerr << "FrameWriter::writePng(): unable to open " << path << "\n";
+		return false;
+	}
+	const bool success{ std::fwrite(file.data(), 1, file.size(), output) == file.size() };
+	std::fclose(output);
+	if (!success)
+	{
+		std::cerr << "FrameWriter::writePng(): unable to write " << path << "\n";
+	}
+	return success;
+}
@@ -0,0 +1,63 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+	Writes rendered RGBA frames, top row first, either as one raw stream
+	(readable by e.g. ffmpeg -f rawvideo -pixel_format rgba) or as a
+	numbered PNG sequence. PNGs are written with uncompressed deflate
+	blocks, which keeps the writer free of dependencies and fast at the
+	cost of file size.
+*/
+class FrameWriter
+{
+public:
+	enum Format
+	{
+		Raw,	// every frame appended to a single file, "-" writes to stdout
+		Png		// one file per frame, path_000000.png, path_000001.png, ...
+	};
+
+	// default constructor
+	FrameWriter();
+
+	// destructor, closes the raw stream
+	~FrameWriter();
+
+	FrameWriter(const FrameWriter &) = delete;
+	FrameWriter &operator=(const FrameWriter &) = delete;
+
+	/*
+		Prepares writing frames of the given size.
+
+		path - raw stream file, or prefix of the PNG files
+		format - raw stream or PNG sequence
+		width, height - frame size in pixels
+
+		Returns true on success and false on failure.
+	*/
+	bool open(const std::string &path, Format format, int width, int height);
+
+	// write one frame of width * height RGBA pixels, top row first
+	bool write(const std::vector<unsigned char> &pixels);
+
+	void close();				// flush and close the raw stream
+	int getFrameCount() const;	// retrieve the amount of frames written
+
+	// write a single RGBA image, top row first, as a PNG file
+	static bool writePng(const std::string &path, const unsigned char* pixels, int width, int height);
+
+private:
+	std::string path;
+	Format format;
+	int width;
+	int height;
+	int frameCount;
+	std::FILE* stream;
+	bool ownsStream;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef GL_HANDLE_H
+#define GL_HANDLE_H
+
+#include <glad/glad.h>
+
+/*
+	Move-only owner of one OpenGL object. The object is deleted when the
+	handle is destroyed or reset, and moving transfers ownership, so
+	handles can live in containers and be returned by value without
+	copies deleting objects that are still in use.
+
+	Name - type of the object name (GLuint, or GLsync for fences)
+	Deleter - function object deleting a name
+*/
+template <typename Name, typename Deleter>
+class GLHandle
+{
+public:
+	// empty handle, owns nothing
+	GLHandle() : name{}
+	{
+	}
+
+	// take ownership of an existing object
+	explicit GLHandle(Name name) : name{ name }
+	{
+	}
+
+	// destructor, delete the owned object
+	~GLHandle()
+	{
+		reset();
+	}
+
+	GLHandle(const GLHandle &) = delete;
+	GLHandle &operator=(const GLHandle &) = delete;
+
+	// move constructor, other is left empty
+	GLHandle(GLHandle &&other) noexcept : name{ other.release() }
+	{
+	}
+
+	// move assignment, deletes the currently owned object
+	GLHandle &operator=(GLHandle &&other) noexcept
+	{
+		if (this != &other)
+		{
+			reset(other.release());
+		}
+		return *this;
+	}
+
+	Name get() const				// retrieve the object name
+	{
+		return name;
+	}
+
+	explicit operator bool() const	// retrieve whether an object is owned
+	{
+		return name != Name{};
+	}
+
+	Name release()					// give up ownership without deleting
+	{
+		Name released{ name };
+		name = Name{};
+		return released;
+	}
+
+	void reset(Name newName = Name{})	// delete the owned object and own newName
+	{
+		if (name != Name{})
+		{
+			Deleter()(name);
+		}
+		name = newName;
+	}
+
+private:
+	Name name;
+};
+
+namespace GLDelete
+{
+	struct Buffer { void operator()(GLuint name) const { glDeleteBuffers(1, &name); } };
+	struct VertexArray { void operator()(GLuint name) const { glDeleteVertexArrays(1, &name); } };
+	struct Texture { void operator()(GLuint name) const { glDeleteTextures(1, &name); } };
+	struct Framebuffer { void operator()(GLuint name) const { glDeleteFramebuffers(1, &name); } };
+	struct Renderbuffer { void operator()(GLuint name) const { glDeleteRenderbuffers(1, &name); } };
+	struct Query { void operator()(GLuint name) const { glDeleteQueries(1, &name); } };
+	struct Program { void operator()(GLuint name) const { glDeleteProgram(name); } };
+	struct Shader { void operator()(GLuint name) const { glDeleteShader(name); } };
+	struct Sync { void operator()(GLsync sync) const { glDeleteSync(sync); } };
+}
+
+typedef GLHandle<GLuint, GLDelete::Buffer> GLBuffer;
+typedef GLHandle<GLuint, GLDelete::VertexArray> GLVertexArray;
+typedef GLHandle<GLuint, GLDelete::Texture> GLTexture;
+typedef GLHandle<GLuint, GLDelete::Framebuffer> GLFramebuffer;
+typedef GLHandle<GLuint, GLDelete::Renderbuffer> GLRenderbuffer;
+typedef GLHandle<GLuint, GLDelete::Query> GLQuery;
+typedef GLHandle<GLuint, GLDelete::Program> GLProgram;
+typedef GLHandle<GLuint, GLDelete::Shader> GLShader;
+typedef GLHandle<GLsync, GLDelete::Sync> GLSync;
+
+// generate a single object of each kind
+namespace GLCreate
+{
+	inline GLBuffer buffer() { GLuint name; glGenBuffers(1, &name); return GLBuffer(name); }
+	inline GLVertexArray vertexArray() { GLuint name; glGenVertexArrays(1, &name); return GLVertexArray(name); }
+	inline GLTexture texture() { GLuint name; glGenTextures(1, &name); return GLTexture(name); }
+	inline GLFramebuffer framebuffer() { GLuint name; glGenFramebuffers(1, &name); return GLFramebuffer(name); }
+	inline GLRenderbuffer renderbuffer() { GLuint name; glGenRenderbuffers(1, &name); return GLRenderbuffer(name); }
+	inline GLQuery query() { GLuint name; glGenQueries(1, &name); return GLQuery(name); }
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "gpu_timer.h"
+
+// ring of queryCount queries
+GpuTimer::GpuTimer(int queryCount) : first{ 0 }, inFlight{ 0 }, active{ false }
+{
+	for (int query{ 0 }; query < queryCount; ++query)
+	{
+		queries.push_back(GLCreate::query());
+	}
+}
+
+// start timing the following commands
+void GpuTimer::begin()
+{
+	active = inFlight < static_cast<int>(queries.size());
+	if (active)
+	{
+		const int next{ (first + inFlight) % static_cast<int>(queries.size()) };
+		glBeginQuery(GL_TIME_ELAPSED, queries[next].get());
+	}
+}
+
+// stop timing
+void GpuTimer::end()
+{
+	if (active)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		++inFlight;
+		active = false;
+	}
+}
+
+// record every finished measurement into a section of stats
+void GpuTimer::collect(FrameStats &stats, int section)
+{
+	while (inFlight > 0)
+	{
+		const GLuint query{ queries[first].get() };
+		GLint available{ GL_FALSE };
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			return;
+		}
+
+		GLuint64 nanoseconds{ 0 };
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+		stats.record(section, nanoseconds / 1e6);
+		first = (first + 1) % static_cast<int>(queries.size());
+		--inFlight;
+	}
+}
@@ -0,0 +1,34 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "gl_handle.h"
+#include "frame_stats.h"
+
+/*
+	Measures GPU time of a span of commands with GL_TIME_ELAPSED queries.
+	Results arrive a few frames late, so queries are used from a ring and
+	only read once available; if every query is still in flight the span
+	is simply not timed, so the CPU never waits on the GPU.
+*/
+class GpuTimer
+{
+public:
+	// ring of queryCount queries
+	explicit GpuTimer(int queryCount = 4);
+
+	void begin();		// start timing the following commands
+	void end();			// stop timing
+
+	// record every finished measurement into a section of stats
+	void collect(FrameStats &stats, int section);
+
+private:
+	std::vector<GLQuery> queries;
+	int first;			// oldest query in flight
+	int inFlight;		// amount of queries in flight
+	bool active;		// whether begin() started a query
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "headless.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include <glad/glad.h>
+
+#include "egl_context.h"
+#include "offscreen_target.h"
+#include "frame_writer.h"
+#include "window.h"
+#include "spectrum.h"
+#include "waterfall.h"
+#include "sound.h"
+#include "band_mapper.h"
+#include "spectrum_kernel.h"
+
+namespace
+{
+	// analysis and display settings, matching the defaults of the window
+	const int s_fftSize{ 8192 };
+	const float s_intensity{ 0.20f };
+	const int s_octaveFraction{ 12 };
+	const int s_waterfallRows{ 512 };
+}
+
+namespace Headless
+{
+	/*
+		Parses command line arguments of the form
+		--headless <audio> <output> [--png] [--fps n] [--seconds s] [--waterfall]
+	*/
+	bool parseArguments(int argc, char* argv[], Options &optionsOut)
+	{
+		if (argc < 4 || std::strcmp(argv[1], "--headless") != 0)
+		{
+			return false;
+		}
+
+		optionsOut.audioPath = argv[2];
+		optionsOut.outputPath = argv[3];
+		optionsOut.png = false;
+		optionsOut.framesPerSecond = 60;
+		optionsOut.seconds = 0.0f;
+		optionsOut.waterfall = false;
+		for (int arg{ 4 }; arg < argc; ++arg)
+		{
+			if (std::strcmp(argv[arg], "--png") == 0)
+			{
+				optionsOut.png = true;
+			}
+			else if (std::strcmp(argv[arg], "--waterfall") == 0)
+			{
+				optionsOut.waterfall = true;
+			}
+			else if (std::strcmp(argv[arg], "--fps") == 0 && arg + 1 < argc)
+			{
+				optionsOut.framesPerSecond = std::atoi(argv[++arg]);
+			}
+			else if (std::strcmp(argv[arg], "--seconds") == 0 && arg + 1 < argc)
+			{
+				optionsOut.seconds = static_cast<float>(std::atof(argv[++arg]));
+			}
+			else
+			{
+				std::cerr << "Headless::parseArguments(): unknown argument " << argv[arg] << "\n";
+				return false;
+			}
+		}
+		return optionsOut.framesPerSecond > 0 && optionsOut.seconds >= 0.0f;
+	}
+
+	// print the headless command line usage
+	void printUsage(const char* program)
+	{
+		std::cerr << "Usage: " << program << " --headless <audio> <output> [--png] [--fps n] [--seconds s] [--waterfall]\n"
+			<< "  output is a raw RGBA stream (\"-\" for stdout) of " << Window::width << "x" << Window::height
+			<< " frames, or the file prefix of a PNG sequence with --png\n";
+	}
+
+	// renders frames of a sound file as described by options
+	int run(const Options &options)
+	{
+		EglContext context;
+		if (!context.create(3, 3))
+		{
+			return 1;
+		}
+
+		// the whole file is decoded first, frames never wait on the decoder
+		Sound sound(options.audioPath, s_fftSize);
+		if (sound.getSampleRate() <= 0)
+		{
+			return 1;
+		}
+		sound.waitForDecode();
+
+		OffscreenTarget target;
+		FrameWriter writer;
+		if (!target.create(Window::width, Window::height) ||
+			!writer.open(options.outputPath, options.png ? FrameWriter::Png : FrameWriter::Raw, Window::width, Window::height))
+		{
+			return 1;
+		}
+
+		// same bands and layout as the window
+		const int binCount{ sound.getBinCount() };
+		const int sampleRate{ sound.getSampleRate() };
+		BandMapper bandMapper;
+		if (!bandMapper.buildOctaves(s_octaveFraction, binCount, sampleRate, 20.0, 20000.0))
+		{
+			return 1;
+		}
+		const int bandCount{ bandMapper.getBandCount() };
+		Spectrum spectrum(bandCount, 1.0f);
+		Waterfall waterfall(bandCount, s_waterfallRows, 75.0f, 100.0f, Window::width - 150.0f, 600.0f);
+		waterfall.setScale(600.0f);
+
+		std::vector<GLfloat> magnitudes(binCount);
+		std::vector<GLfloat> levels(bandCount);
+		SpectrumKernel::Params rawMagnitudes;
+		rawMagnitudes.scale = SpectrumKernel::Magnitude;
+		rawMagnitudes.gain = 1.0f;
+		rawMagnitudes.offset = 0.0f;
+		rawMagnitudes.ceiling = std::numeric_limits<float>::max();
+		SpectrumKernel::Params params;
+		params.scale = SpectrumKernel::Magnitude;
+		params.gain = s_intensity;
+		params.offset = 0.0f;
+		params.ceiling = 600.0f;
+
+		const float duration{ options.seconds > 0.0f ? std::min(options.seconds, sound.getDuration()) : sound.getDuration() };
+		const int frameCount{ static_cast<int>(duration * options.framesPerSecond) };
+		const auto start = std::chrono::steady_clock::now();
+
+		std::vector<GLubyte> pixels;
+		for (int frame{ 0 }; frame < frameCount; ++frame)
+		{
+			// the frame's time comes from its sample position
+			sound.update(static_cast<std::size_t>(frame) * sampleRate / options.framesPerSecond);
+			sound.getLevels(rawMagnitudes, 0, binCount, magnitudes.data());
+			bandMapper.apply(magnitudes.data(), levels.data());
+			SpectrumKernel::convert(levels.data(), bandCount, params, levels.data());
+
+			target.bind();
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			if (options.waterfall)
+			{
+				waterfall.addRow(levels.data());
+				waterfall.draw();
+			}
+			else
+			{
+				spectrum.update(levels.data());
+				spectrum.draw();
+			}
+
+			// the previous frame is written while this one is read back
+			if (target.readFrame(pixels) && !writer.write(pixels))
+			{
+				return 1;
+			}
+		}
+		if (target.readLastFrame(pixels) && !writer.write(pixels))
+		{
+			return 1;
+		}
+		writer.close();
+
+		// report on stderr, stdout may carry the frames
+		const double elapsed{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+		std::cerr << "Rendered " << writer.getFrameCount() << " frames (" << duration << " s of audio) in "
+			<< elapsed << " s, " << (elapsed > 0.0 ? duration / elapsed : 0.0) << "x realtime\n";
+		return 0;
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <string>
+
+/*
+	Renders a sound file to image frames without a window, audio device
+	or GPU. Frames are drawn into an offscreen framebuffer on a
+	surfaceless EGL context and written as a raw RGBA stream or a PNG
+	sequence. Time is taken from the sample position of each frame, not
+	the wall clock, so rendering runs as fast as analysis and drawing
+	allow and every run produces the same frames.
+*/
+namespace Headless
+{
+	struct Options
+	{
+		std::string audioPath;
+		std::string outputPath;		// raw stream file ("-" for stdout) or PNG prefix
+		bool png;					// write a PNG sequence instead of a raw stream
+		int framesPerSecond;
+		float seconds;				// length to render, 0 renders the whole sound
+		bool waterfall;				// render the waterfall instead of the bars
+	};
+
+	/*
+		Parses command line arguments of the form
+		--headless <audio> <output> [--png] [--fps n] [--seconds s] [--waterfall]
+
+		Returns true when headless rendering was requested and the
+		arguments are valid, false otherwise.
+	*/
+	bool parseArguments(int argc, char* argv[], Options &optionsOut);
+
+	// print the headless command line usage
+	void printUsage(const char* program);
+
+	/*
+		Renders frames of a sound file as described by options.
+
+		Returns the process exit code, 0 on success.
+	*/
+	int run(const Options &options);
+}
+
+#endif
@@ -1,17 +1,40 @@
 #include <iostream>
 #include <algorithm>
 #include <string>
+#include <vector>
+#include <limits>
+#include <sstream>
+#include <chrono>
 #include <glad/glad.h>
 #include <SFML/Window.hpp>
 #include <SFML/System.hpp>
 
-#include "shader_program.h"
 #include "window.h"
 #include "spectrum.h"
+#include "render_thread.h"
 #include "sound.h"
+#include "band_mapper.h"
+#include "headless.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "quality_governor.h"
+#include "frame_arena.h"
+#include "alloc_counter.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+	// render to files without a window when asked on the command line
+	if (argc > 1)
+	{
+		Headless::Options options;
+		if (!Headless::parseArguments(argc, argv, options))
+		{
+			Headless::printUsage(argv[0]);
+			return 1;
+		}
+		return Headless::run(options);
+	}
+
 	// opengl ver 3.3 core profile
 	sf::ContextSettings contextSettings;
 	contextSettings.majorVersion = 3;
@@ -27,105 +50,419 @@ int main()
 		return -1;
 	}
 
-	// set bar rendering shaders
-	ShaderProgram program;
-	program.loadProgram("shaders/basic.vert", "shaders/basic.frag");
-	Bar::setProgram(program);
-
-	// initialize spectrum of bars
-	Spectrum spectrum(4096, 0.0f);
-
 	std::cout << "FREQUENCY SPECTRUM VISUALIZER\n\n";
 	std::cout << "Controls\n--------\n";
 	std::cout << "Space\t\tToggle Audio Playback\n";
 	std::cout << "Up\t\tIncrease Bar Height\n";
 	std::cout << "Down\t\tDecrease Bar Height\n";
+	std::cout << "Left\t\tSeek Backward 5 Seconds\n";
+	std::cout << "Right\t\tSeek Forward 5 Seconds\n";
+	std::cout << "[ / ]\t\tDecrease / Increase Output Latency Compensation\n";
+	std::cout << "M\t\tToggle Multirate Analysis\n";
+	std::cout << "D\t\tToggle Decibel Scale\n";
+	std::cout << "B\t\tCycle Band Scale (log, mel, bark, 1/12 octave)\n";
+	std::cout << "W\t\tToggle Waterfall View\n";
+	std::cout << "L\t\tToggle Split Layout (bars, waterfall, left and right channel)\n";
+	std::cout << "R\t\tCycle Render Mode (bars, line, filled area)\n";
+	std::cout << "I\t\tToggle Curve Interpolation\n";
+	std::cout << "G\t\tToggle Max/RMS Merging of Sub-Pixel Bars\n";
+	std::cout << "F\t\tCycle Frame Pacing (vsync, 60 fps cap, uncapped)\n";
+	std::cout << "T\t\tToggle Frame Timing Dump\n";
+	std::cout << "Q\t\tToggle Automatic Quality (FFT size, analysis rate, curve detail)\n";
 	std::cout << "Esc\t\tClose Window\n\n";
 
 	std::cout << "Specify audio path (mp3 not supported): ";
 	std::string audioPath;
 	std::getline(std::cin, audioPath);
 
-	// load sound file and play
-	Sound mySound(audioPath, 8192);
+	// load sound file and play, long files keep decoding in the background
+	sf::Clock startupClock;
+	// quality starts at an 8192 point FFT every frame and adapts to a 60 fps budget
+	QualityGovernor governor(1000.0 / 60.0, 3);
+	Sound mySound(audioPath, governor.getLevel().fftSize);
+
+	// map precomputed spectra next to the audio file, building them on first run
+	if (!mySound.loadCache(audioPath + ".spectrogram", 1024))
+	{
+		std::cout << "Spectrogram cache unavailable, analyzing during playback\n";
+	}
 	mySound.play();
 
+	// display bands of the bins between 20 Hz and 20 kHz. Every scale uses the
+	// band count of twelfth octaves, so all of them fill the same bars
+	int binCount{ mySound.getBinCount() };
+	const int sampleRate{ mySound.getSampleRate() };
+	BandMapper bandMapper;
+	if (!bandMapper.buildOctaves(12, binCount, sampleRate, 20.0, 20000.0))
+	{
+		return -1;
+	}
+	const int bandCount{ bandMapper.getBandCount() };
+	int bandScale{ 3 };
+	auto buildBands = [&]()
+	{
+		if (bandScale == 3)
+		{
+			bandMapper.buildOctaves(12, binCount, sampleRate, 20.0, 20000.0);
+		}
+		else
+		{
+			bandMapper.build(static_cast<BandMapper::Scale>(bandScale), bandCount, binCount, sampleRate, 20.0, 20000.0);
+		}
+	};
+
+	// every GL object lives on the render thread, which takes over the window's context
+	window.setActive(false);
+	// sources are the mixed signal, then the left and right channel
+	const int sourceCount{ 3 };
+	RenderThread renderer(window, bandCount, sourceCount);
+	renderer.start();
+	auto makeCommand = [](RenderCommand::Type type, int value)
+	{
+		RenderCommand command{};
+		command.type = type;
+		command.value = value;
+		return command;
+	};
+	bool showWaterfall{ false };
+	bool splitLayout{ false };
+	int renderMode{ Spectrum::Bars };
+	bool rmsMerge{ false };
+	bool smoothCurve{ true };
+	int pacing{ FramePacer::Vsync };
+
+	bool firstFrame{ true };
 	bool windowIsOpen{ true };
 	float intensity = 0.20f;
+	bool decibels{ false };
+	// analysis time is summed per displayed frame for the governor, and lower
+	// quality levels analyze once every few display frame intervals
+	double frameAnalysisTime{ 0.0 };
+	std::size_t recordedFrames{ 0 };
+	std::chrono::steady_clock::time_point lastAnalysis{};
+	const std::size_t levelCount{ static_cast<std::size_t>(bandCount) * sourceCount };
+
+	// per frame scratch (magnitudes and levels), sized for the largest FFT
+	// so steady state frames never allocate
+	FrameArena frameArena((QualityGovernor::getLevel(QualityGovernor::getLevelCount() - 1).fftSize / 2 + levelCount) * sizeof(GLfloat) + 64);
+
+	// bins are aggregated as plain magnitudes, scaling happens per band
+	SpectrumKernel::Params rawMagnitudes;
+	rawMagnitudes.scale = SpectrumKernel::Magnitude;
+	rawMagnitudes.gain = 1.0f;
+	rawMagnitudes.offset = 0.0f;
+	rawMagnitudes.ceiling = std::numeric_limits<float>::max();
+
+	// timing of the event thread's stages, dumped once per second when enabled.
+	// The render thread keeps and dumps its own
+	FrameStats stats;
+	const int eventSection{ stats.addSection("events") };
+	const int soundSection{ stats.addSection("sound update") };
+	const int bandSection{ stats.addSection("bins to bars") };
+	const int loopSection{ stats.addSection("event loop") };
+	bool dumpStats{ false };
+	sf::Clock dumpClock;
+	std::size_t dumpedAllocations{ 0 };
+
+	// levels are only recomputed when the sound or a display setting changed,
+	// and only sent to the render thread when they differ from the last ones
+	// levels are never negative, so the first ones always differ
+	std::vector<GLfloat> publishedLevels(levelCount, -1.0f);
+	bool levelsDirty{ true };
+	bool idle{ false };
+	// a published snapshot the render thread has not taken yet would only be
+	// replaced by the next one, so no analysis runs until it is taken
+	bool awaitingConsumer{ false };
 	while (windowIsOpen)
 	{
-		window.setActive();
+		// nothing changes while idle, so block until the next event instead of polling
 		sf::Event event;
-		while (window.pollEvent(event))
+		bool hasEvent{ idle && window.waitEvent(event) };
+
+		ScopedTimer loopTimer(stats, loopSection);
 		{
-			if (event.type == sf::Event::KeyPressed)
+			ScopedTimer eventTimer(stats, eventSection);
+			for (hasEvent = hasEvent || window.pollEvent(event); hasEvent; hasEvent = window.pollEvent(event))
 			{
-				if (event.key.code == sf::Keyboard::Space)
+				if (event.type == sf::Event::KeyPressed)
 				{
-					mySound.toggle();
-				}
+					// most keys change how levels are computed, recomputing is cheap
+					levelsDirty = true;
+
+					if (event.key.code == sf::Keyboard::Space)
+					{
+						mySound.toggle();
+					}
 
-				if (event.key.code == sf::Keyboard::Escape)
+					if (event.key.code == sf::Keyboard::Escape)
+					{
+						windowIsOpen = false;
+					}
+
+					if (event.key.code == sf::Keyboard::Up)
+					{
+						if (intensity < 1.0f)
+						{
+							intensity += .01f;
+						}
+					}
+
+					if (event.key.code == sf::Keyboard::Down)
+					{
+						if (intensity > .009f)
+						{
+							intensity -= .01f;
+						}
+					}
+
+					if (event.key.code == sf::Keyboard::D)
+					{
+						decibels = !decibels;
+					}
+
+					if (event.key.code == sf::Keyboard::W)
+					{
+						showWaterfall = !showWaterfall;
+						renderer.post(makeCommand(RenderCommand::ShowWaterfall, showWaterfall));
+					}
+
+					if (event.key.code == sf::Keyboard::B)
+					{
+						bandScale = (bandScale + 1) % 4;
+						buildBands();
+					}
+
+					if (event.key.code == sf::Keyboard::L)
+					{
+						splitLayout = !splitLayout;
+						renderer.post(makeCommand(RenderCommand::Layout, splitLayout));
+					}
+
+					if (event.key.code == sf::Keyboard::R)
+					{
+						renderMode = (renderMode + 1) % 3;
+						renderer.post(makeCommand(RenderCommand::RenderMode, renderMode));
+					}
+
+					if (event.key.code == sf::Keyboard::I)
+					{
+						smoothCurve = !smoothCurve;
+						renderer.post(makeCommand(RenderCommand::Subdivisions, smoothCurve ? governor.getLevel().subdivisions : 1));
+					}
+
+					if (event.key.code == sf::Keyboard::G)
+					{
+						rmsMerge = !rmsMerge;
+						renderer.post(makeCommand(RenderCommand::Aggregate, rmsMerge ? Spectrum::Rms : Spectrum::Max));
+					}
+
+					if (event.key.code == sf::Keyboard::F)
+					{
+						pacing = (pacing + 1) % 3;
+						renderer.post(makeCommand(RenderCommand::Pacing, pacing));
+						std::cout << "Frame pacing: " << FramePacer::getModeName(static_cast<FramePacer::Mode>(pacing)) << '\n';
+					}
+
+					if (event.key.code == sf::Keyboard::T)
+					{
+						dumpStats = !dumpStats;
+						renderer.post(makeCommand(RenderCommand::DumpStats, dumpStats));
+						dumpClock.restart();
+					}
+
+					if (event.key.code == sf::Keyboard::Q)
+					{
+						governor.setEnabled(!governor.isEnabled());
+						std::cout << "Automatic quality " << (governor.isEnabled() ? "on" : "off") << '\n';
+					}
+
+					if (event.key.code == sf::Keyboard::LBracket || event.key.code == sf::Keyboard::RBracket)
+					{
+						const float step{ event.key.code == sf::Keyboard::RBracket ? 0.01f : -0.01f };
+						mySound.setOutputLatency(std::max(mySound.getOutputLatency() + step, 0.0f));
+						std::cout << "Output latency " << static_cast<int>(mySound.getOutputLatency() * 1000.0f + 0.5f) << " ms\n";
+					}
+
+					if (event.key.code == sf::Keyboard::M)
+					{
+						mySound.setMultirate(!mySound.getMultirate());
+					}
+
+					if (event.key.code == sf::Keyboard::Left)
+					{
+						mySound.setPlayingOffset(std::max(mySound.getPlayingOffset() - 5.0f, 0.0f));
+					}
+
+					if (event.key.code == sf::Keyboard::Right)
+					{
+						mySound.setPlayingOffset(std::min(mySound.getPlayingOffset() + 5.0f, mySound.getDuration()));
+					}
+				}
+				if (event.type == sf::Event::Closed)
 				{
 					windowIsOpen = false;
 				}
-
-				if (event.key.code == sf::Keyboard::Up)
+				else if (event.type == sf::Event::GainedFocus)
 				{
-					if (intensity < 1.0f)
-					{
-						intensity += .01f;
-					}
+					renderer.post(makeCommand(RenderCommand::Redraw, 0));
 				}
-
-				if (event.key.code == sf::Keyboard::Down)
+				else if (event.type == sf::Event::Resized)
 				{
-					if (intensity > .009f)
+					int ratioWidth{ 1 };
+					int ratioHeight{ 1 };
+
+					RenderCommand viewport{ makeCommand(RenderCommand::Viewport, 0) };
+					if (event.size.width * ratioHeight > event.size.height * ratioWidth)
+					{
+						viewport.height = event.size.height;
+						viewport.width = viewport.height * ratioWidth / ratioHeight;
+						viewport.x = (event.size.width - viewport.width) / 2;
+					}
+					else
 					{
-						intensity -= .01f;
+						viewport.width = event.size.width;
+						viewport.height = viewport.width * ratioHeight / ratioWidth;
+						viewport.y = (event.size.height - viewport.height) / 2;
 					}
+					renderer.post(viewport);
 				}
 			}
-			if (event.type == sf::Event::Closed)
-			{
-				windowIsOpen = false;
-			}
-			else if (event.type == sf::Event::Resized)
-			{
-				int ratioWidth{ 1 };
-				int ratioHeight{ 1 };
+		}
 
-				GLuint width, height;
-				if (event.size.width * ratioHeight > event.size.height * ratioWidth)
+		// while playing, lower quality levels only analyze once every hopFrames
+		// display frame intervals, less a little slack for wake-up jitter
+		const bool playing{ mySound.getStatus() == sf::SoundSource::Playing };
+		const std::chrono::steady_clock::time_point analysisStart{ std::chrono::steady_clock::now() };
+		const int hopFrames{ governor.getLevel().hopFrames };
+		const bool analysisDue{ !playing || hopFrames == 1 ||
+			std::chrono::duration<double, std::milli>(analysisStart - lastAnalysis).count() >= (hopFrames - 0.1) * governor.getBudget() };
+		bool soundChanged{ false };
+		if (!awaitingConsumer && analysisDue)
+		{
+			ScopedTimer soundTimer(stats, soundSection);
+			lastAnalysis = analysisStart;
+			soundChanged = mySound.update();
+		}
+
+		// sum bins into bands with one sparse pass, then scale and clamp
+		// bands to bar heights. In decibel mode the default intensity
+		// shows 75 dB over the full bar height
+		bool published{ false };
+		if (!awaitingConsumer && (soundChanged || levelsDirty))
+		{
+			ScopedTimer bandTimer(stats, bandSection);
+			frameArena.reset();
+			GLfloat* magnitudes{ frameArena.allocate<GLfloat>(binCount) };
+			GLfloat* levels{ frameArena.allocate<GLfloat>(levelCount) };
+			mySound.getLevels(rawMagnitudes, 0, binCount, magnitudes);
+			bandMapper.apply(magnitudes, levels);
+
+			SpectrumKernel::Params params;
+			params.scale = decibels ? SpectrumKernel::Decibel : SpectrumKernel::Magnitude;
+			params.gain = decibels ? intensity * 40.0f : intensity; // arbitrary scaling value
+			params.offset = 0.0f;
+			params.ceiling = 600.0f;
+			SpectrumKernel::convert(levels, bandCount, params, levels);
+
+			// channels are transformed separately, only while the split layout shows them,
+			// and silent otherwise. Mono sound shows the mixed signal in both
+			for (int source{ 1 }; source < sourceCount; ++source)
+			{
+				GLfloat* channelLevels{ levels + static_cast<std::size_t>(source) * bandCount };
+				if (splitLayout && mySound.getChannelLevels(std::min(source - 1, mySound.getChannelCount() - 1), rawMagnitudes, 0, binCount, magnitudes))
 				{
-					height = event.size.height;
-					width = height * ratioWidth / ratioHeight;
-					glViewport((event.size.width - width) / 2, 0, width, height);
+					bandMapper.apply(magnitudes, channelLevels);
+					SpectrumKernel::convert(channelLevels, bandCount, params, channelLevels);
 				}
 				else
 				{
-					width = event.size.width;
-					height = width * ratioHeight / ratioWidth;
-					glViewport(0, (event.size.height - height) / 2, width, height);
+					std::fill(channelLevels, channelLevels + bandCount, 0.0f);
 				}
 			}
+
+			// every analysis while playing is a waterfall row, even when it repeats
+			// the last one (e.g. silence, or the same cached frame). Otherwise
+			// unchanged levels are not sent again
+			if ((playing && soundChanged) || !std::equal(levels, levels + levelCount, publishedLevels.begin()))
+			{
+				renderer.publish(levels, playing);
+				std::copy(levels, levels + levelCount, publishedLevels.begin());
+				published = true;
+			}
+			levelsDirty = false;
 		}
 
-		mySound.update();
-		for (int bin{ 1 }; bin < 4096; ++bin)
+		// step quality up or down when the analysis or drawing outgrows the frame
+		// budget, once per displayed frame. A snapshot stays on screen for
+		// hopFrames frame intervals, so its analysis is spread over them
+		frameAnalysisTime = playing ? frameAnalysisTime + std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - analysisStart).count() : 0.0;
+		bool qualityChanged{ false };
+		const std::size_t presentedFrames{ renderer.getPresentedCount() };
+		if (presentedFrames != recordedFrames)
 		{
-			GLfloat value = static_cast<GLfloat>(abs(mySound.fftBins[bin])) * intensity; // arbitrary scaling value
-			spectrum.bars[bin - 1].setHeight(std::min(value, 600.0f));
+			recordedFrames = presentedFrames;
+
+			// reading the spectrogram cache costs next to nothing, which is no
+			// headroom for a larger FFT the cache does not hold
+			governor.setMaxLevel(mySound.isCached() ? governor.getLevelIndex() : QualityGovernor::getLevelCount() - 1);
+			qualityChanged = playing && governor.record(frameAnalysisTime / hopFrames, renderer.getRenderTime());
+			frameAnalysisTime = 0.0;
+		}
+		if (qualityChanged)
+		{
+			const QualityGovernor::Level &level{ governor.getLevel() };
+			mySound.setFftSize(level.fftSize);
+			binCount = mySound.getBinCount();
+			buildBands();
+			renderer.post(makeCommand(RenderCommand::Subdivisions, smoothCurve ? level.subdivisions : 1));
+
+			// the bins of the new size are empty until analyzed, so the next
+			// iteration analyzes regardless of the hop and publishes from there
+			lastAnalysis = std::chrono::steady_clock::time_point{};
+			std::cout << "Quality level " << governor.getLevelIndex() << ": " << level.fftSize << " point FFT every "
+				<< level.hopFrames << " frame(s), " << level.subdivisions << " curve subdivisions\n";
+		}
+
+		if (dumpStats && dumpClock.getElapsedTime().asSeconds() >= 1.0f)
+		{
+			// one write, so lines of the render thread's dump do not interleave
+			std::ostringstream dump;
+			dump << "Event timing (last " << stats.getSummary(loopSection).count << " iterations)\n";
+			stats.print(dump);
+			if (AllocationCounter::isEnabled())
+			{
+				dump << AllocationCounter::getThreadCount() - dumpedAllocations << " heap allocations since the last dump\n";
+			}
+			dump << '\n';
+			std::cout << dump.str() << std::flush;
+			dumpClock.restart();
+			// the dump's own allocations are not counted against the frames
+			dumpedAllocations = AllocationCounter::getThreadCount();
 		}
 
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+		if (firstFrame && renderer.hasPresented())
+		{
+			std::cout << "First frame after " << startupClock.getElapsedTime().asMilliseconds() << " ms\n";
+			firstFrame = false;
+		}
 
-		spectrum.update();
-		spectrum.draw();
+		// paused or stopped with every level sent, the next change can only come from an event
+		awaitingConsumer = awaitingConsumer || published;
+		idle = !playing && !mySound.isAnalysisPending() && renderer.hasPresented() && !awaitingConsumer;
 
-		window.display();
+		// analyze once per snapshot the render thread takes, which is once per
+		// displayed frame, but keep polling events every few milliseconds while
+		// it is busy drawing or waiting for vsync
+		if (awaitingConsumer)
+		{
+			awaitingConsumer = !renderer.waitForConsumer(std::chrono::milliseconds(4));
+		}
+		else if (!idle)
+		{
+			sf::sleep(sf::milliseconds(1));
+		}
 	}
 
+	renderer.stop();
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "mapped_file.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// default constructor
+#ifdef _WIN32
+MappedFile::MappedFile() : data{ nullptr }, size{ 0 }, fileHandle{ INVALID_HANDLE_VALUE }, mappingHandle{ nullptr }
+{
+}
+#else
+MappedFile::MappedFile() : data{ nullptr }, size{ 0 }, fileDescriptor{ -1 }
+{
+}
+#endif
+
+// destructor, unmaps the file if it is still open
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+// map an entire file into memory as read-only
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+#ifdef _WIN32
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle)
+	{
+		std::cerr << "MappedFile::open(): unable to create file mapping\n";
+		close();
+		return false;
+	}
+
+	data = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!data)
+	{
+		std::cerr << "MappedFile::open(): unable to map view of file\n";
+		close();
+		return false;
+	}
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+	{
+		close();
+		return false;
+	}
+
+	void* mapping{ mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_SHARED, fileDescriptor, 0) };
+	if (mapping == MAP_FAILED)
+	{
+		std::cerr << "MappedFile::open(): unable to map file\n";
+		close();
+		return false;
+	}
+	data = static_cast<const unsigned char*>(mapping);
+	size = static_cast<std::size_t>(fileStatus.st_size);
+#endif
+
+	return true;
+}
+
+// unmap the file and release its handles
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (data)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle)
+	{
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle);
+	}
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (data)
+	{
+		munmap(const_cast<unsigned char*>(data), size);
+	}
+	if (fileDescriptor >= 0)
+	{
+		::close(fileDescriptor);
+	}
+	fileDescriptor = -1;
+#endif
+
+	data = nullptr;
+	size = 0;
+}
+
+// retrieve pointer to the first mapped byte
+const unsigned char* MappedFile::getData() const
+{
+	return data;
+}
+
+// retrieve the size of the mapping in bytes
+std::size_t MappedFile::getSize() const
+{
+	return size;
+}
+
+// retrieve whether a file is currently mapped
+bool MappedFile::isOpen() const
+{
+	return data != nullptr;
+}
@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+	// default constructor
+	MappedFile();
+
+	// destructor, unmaps the file if it is still open
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool open(const std::string &path);		// map an entire file into memory as read-only
+	void close();							// unmap the file and release its handles
+
+	const unsigned char* getData() const;	// retrieve pointer to the first mapped byte
+	std::size_t getSize() const;			// retrieve the size of the mapping in bytes
+	bool isOpen() const;					// retrieve whether a file is currently mapped
+
+private:
+	const unsigned char* data;
+	std::size_t size;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include "mapped_pcm.h"
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	// reads a little endian integer from a byte pointer
+	std::uint32_t readU32(const unsigned char* bytes)
+	{
+		return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+	}
+
+	std::uint16_t readU16(const unsigned char* bytes)
+	{
+		return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+	}
+
+	// WAVE format tags
+	const std::uint16_t s_formatPcm{ 0x0001 };
+	const std::uint16_t s_formatFloat{ 0x0003 };
+	const std::uint16_t s_formatExtensible{ 0xFFFE };
+}
+
+// default constructor
+MappedPcm::MappedPcm() : format{ None }, samples{ nullptr }, sampleCount{ 0 }, channelCount{ 0 }, sampleRate{ 0 }
+{
+}
+
+// maps a RIFF WAVE file holding 16-bit integer or 32-bit float PCM
+bool MappedPcm::openWav(const std::string &path)
+{
+	close();
+	if (!file.open(path))
+	{
+		return false;
+	}
+
+	const unsigned char* bytes{ file.getData() };
+	const std::size_t size{ file.getSize() };
+	if (size < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0)
+	{
+		close();
+		return false;
+	}
+
+	// walk the chunk list for the format description and sample data
+	std::uint16_t formatTag{ 0 };
+	std::uint16_t bitsPerSample{ 0 };
+	const unsigned char* data{ nullptr };
+	std::size_t dataSize{ 0 };
+	std::size_t offset{ 12 };
+	while (offset + 8 <= size)
+	{
+		const unsigned char* chunk{ bytes + offset };
+		const std::size_t chunkSize{ readU32(chunk + 4) };
+		const std::size_t available{ size - offset - 8 };
+
+		if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && chunkSize <= available)
+		{
+			formatTag = readU16(chunk + 8);
+			channelCount = readU16(chunk + 10);
+			sampleRate = static_cast<int>(readU32(chunk + 12));
+			bitsPerSample = readU16(chunk + 22);
+			// extensible format stores the real tag at the start of the subformat GUID
+			if (formatTag == s_formatExtensible && chunkSize >= 40)
+			{
+				formatTag = readU16(chunk + 32);
+			}
+		}
+		else if (std::memcmp(chunk, "data", 4) == 0)
+		{
+			// tolerate streamed files whose data size was never patched
+			data = chunk + 8;
+			dataSize = chunkSize <= available ? chunkSize : available;
+			break;
+		}
+
+		// chunks are padded to an even size
+		offset += 8 + chunkSize + (chunkSize & 1);
+	}
+
+	if (formatTag == s_formatPcm && bitsPerSample == 16)
+	{
+		format = Int16;
+	}
+	else if (formatTag == s_formatFloat && bitsPerSample == 32)
+	{
+		format = Float32;
+	}
+
+	const std::size_t sampleSize{ format == Float32 ? sizeof(float) : sizeof(sf::Int16) };
+	if (format == None || !data || channelCount == 0 || sampleRate == 0)
+	{
+		std::cerr << "MappedPcm::openWav(): " << path << " is not 16-bit or float PCM\n";
+		close();
+		return false;
+	}
+	if ((data - bytes) % sampleSize != 0)
+	{
+		std::cerr << "MappedPcm::openWav(): sample data in " << path << " is misaligned\n";
+		close();
+		return false;
+	}
+
+	samples = data;
+	sampleCount = dataSize / sampleSize;
+	sampleCount -= sampleCount % channelCount;
+	return true;
+}
+
+// maps a headerless file of interleaved samples in native byte order
+bool MappedPcm::openRaw(const std::string &path, Format format, int channelCount, int sampleRate)
+{
+	close();
+	if (format == None || channelCount <= 0 || sampleRate <= 0 || !file.open(path))
+	{
+		return false;
+	}
+
+	const std::size_t sampleSize{ format == Float32 ? sizeof(float) : sizeof(sf::Int16) };
+	this->format = format;
+	this->channelCount = channelCount;
+	this->sampleRate = sampleRate;
+	samples = file.getData();
+	sampleCount = file.getSize() / sampleSize;
+	sampleCount -= sampleCount % channelCount;
+	return true;
+}
+
+// unmap the file
+void MappedPcm::close()
+{
+	file.close();
+	format = None;
+	samples = nullptr;
+	sampleCount = 0;
+	channelCount = 0;
+	sampleRate = 0;
+}
+
+// retrieve whether a file is mapped
+bool MappedPcm::isOpen() const
+{
+	return samples != nullptr;
+}
+
+// retrieve the sample format of the view
+MappedPcm::Format MappedPcm::getFormat() const
+{
+	return format;
+}
+
+// retrieve 16-bit view (nullptr unless format is Int16)
+const sf::Int16* MappedPcm::getInt16Samples() const
+{
+	return format == Int16 ? reinterpret_cast<const sf::Int16*>(samples) : nullptr;
+}
+
+// retrieve float view (nullptr unless format is Float32)
+const float* MappedPcm::getFloatSamples() const
+{
+	return format == Float32 ? reinterpret_cast<const float*>(samples) : nullptr;
+}
+
+// retrieve the amount of interleaved samples
+std::size_t MappedPcm::getSampleCount() const
+{
+	return sampleCount;
+}
+
+// retrieve the amount of channels
+int MappedPcm::getChannelCount() const
+{
+	return channelCount;
+}
+
+// retrieve sample rate in Hz
+int MappedPcm::getSampleRate() const
+{
+	return sampleRate;
+}
@@ -0,0 +1,54 @@
+#ifndef MAPPED_PCM_H
+#define MAPPED_PCM_H
+
+#include <cstddef>
+#include <string>
+#include <SFML/Audio.hpp>
+#include "mapped_file.h"
+
+/*
+	Memory-mapped source of uncompressed PCM audio. The sample region of
+	a WAV or headerless raw file is exposed in place as an interleaved
+	16-bit or 32-bit float view, so no decoding or copying is done and
+	the page cache serves sample windows directly.
+*/
+class MappedPcm
+{
+public:
+	enum Format
+	{
+		None,
+		Int16,
+		Float32
+	};
+
+	// default constructor
+	MappedPcm();
+
+	// maps a RIFF WAVE file holding 16-bit integer or 32-bit float PCM.
+	// Returns false for any other encoding.
+	bool openWav(const std::string &path);
+
+	// maps a headerless file of interleaved samples in native byte order
+	bool openRaw(const std::string &path, Format format, int channelCount, int sampleRate);
+
+	void close();								// unmap the file
+
+	bool isOpen() const;						// retrieve whether a file is mapped
+	Format getFormat() const;					// retrieve the sample format of the view
+	const sf::Int16* getInt16Samples() const;	// retrieve 16-bit view (nullptr unless format is Int16)
+	const float* getFloatSamples() const;		// retrieve float view (nullptr unless format is Float32)
+	std::size_t getSampleCount() const;			// retrieve the amount of interleaved samples
+	int getChannelCount() const;				// retrieve the amount of channels
+	int getSampleRate() const;					// retrieve sample rate in Hz
+
+private:
+	MappedFile file;
+	Format format;
+	const unsigned char* samples;
+	std::size_t sampleCount;
+	int channelCount;
+	int sampleRate;
+};
+
+#endif
@@ -0,0 +1,166 @@
+#define _USE_MATH_DEFINES
+
+#include "multirate.h"
+#include "fft.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	// nonzero odd taps on each side of the halfband filter center, the
+	// filter has 4 * s_halfbandPairs - 1 taps
+	const int s_halfbandPairs{ 10 };
+
+	// kaiser window shape, about 60 dB of stopband attenuation
+	const double s_kaiserBeta{ 5.65 };
+
+	// a level is used up to this fraction of its nyquist frequency,
+	// above it the halfband transition band and its alias begin
+	const double s_passbandEdge{ 0.8 };
+
+	// zeroth order modified bessel function of the first kind
+	double besselI0(double x)
+	{
+		double sum{ 1.0 };
+		double term{ 1.0 };
+		for (int k{ 1 }; k < 32; ++k)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	}
+}
+
+// levelCount levels, each analyzed with an fftSize point FFT
+MultirateAnalyzer::MultirateAnalyzer(int levelCount, int fftSize, int sampleRate)
+	: levelCount{ std::max(levelCount, 1) }, fftSize{ fftSize }, sampleRate{ sampleRate }
+{
+	// kaiser windowed sinc halfband filter, every even tap but the center is zero
+	const int halfLength{ 2 * s_halfbandPairs - 1 };
+	double tapSum{ 0.0 };
+	for (int pair{ 0 }; pair < s_halfbandPairs; ++pair)
+	{
+		const int n{ 2 * pair + 1 };
+		const double ratio{ static_cast<double>(n) / (halfLength + 1) };
+		const double window{ besselI0(s_kaiserBeta * std::sqrt(1.0 - ratio * ratio)) / besselI0(s_kaiserBeta) };
+		const double tap{ std::sin(M_PI * n / 2.0) / (M_PI * n) * window };
+		halfbandTaps.push_back(tap);
+		tapSum += 2.0 * tap;
+	}
+	// normalize for unity gain at DC (center tap contributes 0.5)
+	for (auto &tap : halfbandTaps)
+	{
+		tap *= 0.5 / tapSum;
+	}
+
+	// the deepest level holds exactly one window, every level above it
+	// holds what the filter needs to produce the level below
+	levels.resize(this->levelCount);
+	std::size_t length{ static_cast<std::size_t>(fftSize) };
+	for (int level{ this->levelCount - 1 }; level >= 0; --level)
+	{
+		levels[level].resize(length);
+		length = 2 * length + 4 * s_halfbandPairs - 2;
+	}
+
+	for (int x{ 0 }; x < fftSize; ++x)
+	{
+		double y = sin((M_PI * x) / (fftSize - 1));
+		hannWindow.push_back(y * y);
+	}
+	fftBins.resize(fftSize);
+	levelMagnitudes.assign(this->levelCount, std::vector<float>(fftSize / 2 + 1, 0.0f));
+}
+
+// set frequencies in Hz at which analyze() reports magnitudes
+void MultirateAnalyzer::setFrequencies(const std::vector<double> &frequencies)
+{
+	sources.clear();
+	for (double frequency : frequencies)
+	{
+		// use the deepest level that still passes the frequency
+		int level{ levelCount - 1 };
+		while (level > 0 && frequency > s_passbandEdge * sampleRate / (2 << level))
+		{
+			--level;
+		}
+
+		const double resolution{ static_cast<double>(sampleRate) / (1 << level) / fftSize };
+		const double position{ std::min(frequency / resolution, fftSize / 2.0) };
+		BinSource source;
+		source.level = level;
+		source.bin = std::min(static_cast<int>(position), fftSize / 2 - 1);
+		source.fraction = static_cast<float>(position - source.bin);
+		sources.push_back(source);
+	}
+}
+
+// analyzes getInputLength() full rate mono samples and writes the
+// magnitude at each frequency passed to setFrequencies()
+void MultirateAnalyzer::analyze(const double* samples, std::vector<float> &magnitudesOut)
+{
+	std::copy(samples, samples + levels[0].size(), levels[0].begin());
+	for (int level{ 1 }; level < levelCount; ++level)
+	{
+		decimate(levels[level - 1], levels[level]);
+	}
+
+	// transform the centered window of each level
+	for (int level{ 0 }; level < levelCount; ++level)
+	{
+		const std::vector<double> &signal{ levels[level] };
+		const std::size_t offset{ (signal.size() - fftSize) / 2 };
+		for (int x{ 0 }; x < fftSize; ++x)
+		{
+			fftBins[x] = signal[offset + x] * hannWindow[x];
+		}
+		FFT::forward(fftBins);
+
+		std::vector<float> &magnitudes{ levelMagnitudes[level] };
+		for (int bin{ 0 }; bin <= fftSize / 2; ++bin)
+		{
+			magnitudes[bin] = static_cast<float>(std::abs(fftBins[bin]));
+		}
+	}
+
+	// interpolate each requested frequency from its level
+	magnitudesOut.resize(sources.size());
+	for (std::size_t x{ 0 }; x < sources.size(); ++x)
+	{
+		const BinSource &source{ sources[x] };
+		const std::vector<float> &magnitudes{ levelMagnitudes[source.level] };
+		magnitudesOut[x] = magnitudes[source.bin] + (magnitudes[source.bin + 1] - magnitudes[source.bin]) * source.fraction;
+	}
+}
+
+// decimate a level by two into the next level. Only every second output
+// sample is computed and the zero taps of the halfband are skipped.
+void MultirateAnalyzer::decimate(const std::vector<double> &input, std::vector<double> &output)
+{
+	const int center{ 2 * s_halfbandPairs - 1 };
+	for (std::size_t m{ 0 }; m < output.size(); ++m)
+	{
+		const double* x{ input.data() + 2 * m + center };
+		double sum{ 0.5 * x[0] };
+		for (int pair{ 0 }; pair < s_halfbandPairs; ++pair)
+		{
+			const int n{ 2 * pair + 1 };
+			sum += halfbandTaps[pair] * (x[-n] + x[n]);
+		}
+		output[m] = sum;
+	}
+}
+
+// retrieve the amount of full rate samples read by analyze()
+int MultirateAnalyzer::getInputLength() const
+{
+	return static_cast<int>(levels[0].size());
+}
+
+// retrieve the amount of decimation levels
+int MultirateAnalyzer::getLevelCount() const
+{
+	return levelCount;
+}
@@ -0,0 +1,55 @@
+#ifndef MULTIRATE_H
+#define MULTIRATE_H
+
+#include <vector>
+#include <complex>
+
+/*
+	Multirate spectrum analyzer. A mono block is repeatedly low-pass
+	filtered and decimated by two with a halfband FIR, producing one
+	level per octave. Every level is transformed with the same small
+	FFT, so each octave down doubles the frequency resolution while the
+	window stays centered on the same instant. Requested frequencies are
+	read from the deepest level whose alias-free band contains them.
+*/
+class MultirateAnalyzer
+{
+public:
+	// levelCount levels, each analyzed with an fftSize point FFT
+	MultirateAnalyzer(int levelCount, int fftSize, int sampleRate);
+
+	// set frequencies in Hz at which analyze() reports magnitudes
+	void setFrequencies(const std::vector<double> &frequencies);
+
+	// analyzes getInputLength() full rate mono samples and writes the
+	// magnitude at each frequency passed to setFrequencies()
+	void analyze(const double* samples, std::vector<float> &magnitudesOut);
+
+	int getInputLength() const;		// retrieve the amount of full rate samples read by analyze()
+	int getLevelCount() const;		// retrieve the amount of decimation levels
+
+private:
+	// decimate a level by two into the next level
+	void decimate(const std::vector<double> &input, std::vector<double> &output);
+
+	// where a requested frequency is read from
+	struct BinSource
+	{
+		int level;
+		int bin;
+		float fraction;
+	};
+
+	int levelCount;
+	int fftSize;
+	int sampleRate;
+
+	std::vector<double> halfbandTaps;				// odd taps of the halfband filter (center tap is 0.5)
+	std::vector<double> hannWindow;
+	std::vector<std::vector<double>> levels;		// decimated signal of each level
+	std::vector<std::vector<float>> levelMagnitudes;
+	std::vector<std::complex<double>> fftBins;
+	std::vector<BinSource> sources;
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "offscreen_target.h"
+
+#include <cstring>
+#include <iostream>
+
+// default constructor
+OffscreenTarget::OffscreenTarget() : width{ 0 }, height{ 0 }, frameIndex{ 0 }, pending{ false, false }
+{
+}
+
+// allocates the framebuffer and pixel buffers
+bool OffscreenTarget::create(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+	frameIndex = 0;
+	pending[0] = pending[1] = false;
+
+	colorBuffer = GLCreate::renderbuffer();
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer.get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	framebuffer = GLCreate::framebuffer();
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer.get());
+	const GLenum status{ glCheckFramebufferStatus(GL_FRAMEBUFFER) };
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "OffscreenTarget::create(): framebuffer incomplete (0x" << std::hex << status << std::dec << ")\n";
+		return false;
+	}
+
+	for (auto &buffer : pixelBuffers)
+	{
+		buffer = GLCreate::buffer();
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.get());
+		glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 4, nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return true;
+}
+
+// render into the target and set the viewport to cover it
+void OffscreenTarget::bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+	glViewport(0, 0, width, height);
+}
+
+// queue the current frame for readback and copy the previously queued frame
+bool OffscreenTarget::readFrame(std::vector<GLubyte> &pixelsOut)
+{
+	const int current{ frameIndex % 2 };
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.get());
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[current].get());
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)(0));
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	pending[current] = true;
+	++frameIndex;
+
+	return copyPixels(1 - current, pixelsOut);
+}
+
+// copy the last queued frame to pixelsOut
+bool OffscreenTarget::readLastFrame(std::vector<GLubyte> &pixelsOut)
+{
+	return copyPixels((frameIndex + 1) % 2, pixelsOut);
+}
+
+// retrieve width in pixels
+int OffscreenTarget::getWidth() const
+{
+	return width;
+}
+
+// retrieve height in pixels
+int OffscreenTarget::getHeight() const
+{
+	return height;
+}
+
+// map a pixel buffer and copy it with the top row first
+bool OffscreenTarget::copyPixels(int buffer, std::vector<GLubyte> &pixelsOut)
+{
+	if (!pending[buffer])
+	{
+		return false;
+	}
+	pending[buffer] = false;
+
+	const std::size_t rowSize{ static_cast<std::size_t>(width) * 4 };
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[buffer].get());
+	const GLubyte* pixels{ static_cast<const GLubyte*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowSize * height, GL_MAP_READ_BIT)) };
+	if (!pixels)
+	{
+		std::cerr << "OffscreenTarget::copyPixels(): failed to map pixel buffer\n";
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		return false;
+	}
+
+	// OpenGL rows start at the bottom, images start at the top
+	pixelsOut.resize(rowSize * height);
+	for (int row{ 0 }; row < height; ++row)
+	{
+		std::memcpy(pixelsOut.data() + row * rowSize, pixels + (height - 1 - row) * rowSize, rowSize);
+	}
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return true;
+}
@@ -0,0 +1,53 @@
+#ifndef OFFSCREEN_TARGET_H
+#define OFFSCREEN_TARGET_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "gl_handle.h"
+
+/*
+	Framebuffer object with an RGBA8 color buffer, read back through two
+	pixel buffer objects. Each readFrame() starts an asynchronous read of
+	the frame just drawn into one PBO and maps the other, which holds the
+	frame before it, so the CPU copies one frame while the next one is
+	still being transferred.
+*/
+class OffscreenTarget
+{
+public:
+	// default constructor
+	OffscreenTarget();
+
+	/*
+		Allocates the framebuffer and pixel buffers.
+
+		Returns true on success and false on failure.
+	*/
+	bool create(int width, int height);
+
+	void bind();			// render into the target and set the viewport to cover it
+
+	// queue the current frame for readback and copy the previously queued
+	// frame (top row first) to pixelsOut, returns false when there is none
+	bool readFrame(std::vector<GLubyte> &pixelsOut);
+
+	// copy the last queued frame to pixelsOut, returns false when there is none
+	bool readLastFrame(std::vector<GLubyte> &pixelsOut);
+
+	int getWidth() const;	// retrieve width in pixels
+	int getHeight() const;	// retrieve height in pixels
+
+private:
+	bool copyPixels(int buffer, std::vector<GLubyte> &pixelsOut);	// map a pixel buffer and copy it flipped
+
+	int width;
+	int height;
+	int frameIndex;
+
+	GLFramebuffer framebuffer;
+	GLRenderbuffer colorBuffer;
+	GLBuffer pixelBuffers[2];
+	bool pending[2];
+};
+
+#endif
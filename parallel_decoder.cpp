@@ -0,0 +1,173 @@
+#include "parallel_decoder.h"
+
+#include <iostream>
+#include <algorithm>
+#include <thread>
+
+namespace ParallelDecoder
+{
+	// amount of sample frames decoded past the end of a range to verify the next boundary
+	const sf::Uint64 s_checkFrames{ 256 };
+
+	// amount of samples read between progress reports
+	const sf::Uint64 s_blockSize{ 16384 };
+
+	/*
+		Reads samples from an open sound file in blocks, reporting the
+		amount read so far after every block.
+
+		Returns true when all samples were read and false on failure
+		or when stopped by the callback.
+	*/
+	bool readSamples(sf::InputSoundFile &file, sf::Int16* dataOut, sf::Uint64 count, const std::function<bool(sf::Uint64)> &onBlock)
+	{
+		sf::Uint64 total{ 0 };
+		while (total < count)
+		{
+			const sf::Uint64 read{ file.read(dataOut + total, std::min(s_blockSize, count - total)) };
+			if (read == 0)
+			{
+				return false;
+			}
+			total += read;
+			if (onBlock && !onBlock(total))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*
+		Decodes the samples [start, end) of a file, followed by up to
+		checkCount samples past the end of the range.
+
+		path - audio file to decode
+		start, end - interleaved sample range, multiples of the channel count
+		dataOut - pointer to hold end - start samples
+		checkOut - vector to hold the samples past the end of the range
+		checkCount - amount of samples to decode past the end of the range
+
+		Returns true on success and false on failure.
+	*/
+	bool decodeRange(const std::string &path, sf::Uint64 start, sf::Uint64 end, sf::Int16* dataOut, std::vector<sf::Int16> &checkOut, sf::Uint64 checkCount)
+	{
+		sf::InputSoundFile file;
+		if (!file.openFromFile(path))
+		{
+			std::cerr << "ParallelDecoder::decodeRange(): unable to open " << path << '\n';
+			return false;
+		}
+		if (start > 0)
+		{
+			file.seek(start);
+		}
+
+		if (!readSamples(file, dataOut, end - start))
+		{
+			std::cerr << "ParallelDecoder::decodeRange(): file ended before sample " << end << '\n';
+			return false;
+		}
+
+		checkOut.resize(static_cast<std::size_t>(checkCount));
+		sf::Uint64 checked{ 0 };
+		while (checked < checkCount)
+		{
+			const sf::Uint64 count{ file.read(checkOut.data() + checked, checkCount - checked) };
+			if (count == 0)
+			{
+				break;
+			}
+			checked += count;
+		}
+		checkOut.resize(static_cast<std::size_t>(checked));
+		return true;
+	}
+
+	/*
+		Decodes an entire audio file into interleaved 16-bit samples
+		using several threads. Length of samplesOut is set to the
+		amount of samples in the file.
+
+		Returns true on success and false on failure.
+	*/
+	bool decode(const std::string &path, std::vector<sf::Int16> &samplesOut, unsigned int &channelCount, unsigned int &sampleRate, unsigned int threadCount)
+	{
+		sf::Uint64 sampleCount;
+		{
+			sf::InputSoundFile file;
+			if (!file.openFromFile(path))
+			{
+				std::cerr << "ParallelDecoder::decode(): unable to open " << path << '\n';
+				return false;
+			}
+			channelCount = file.getChannelCount();
+			sampleRate = file.getSampleRate();
+			sampleCount = file.getSampleCount();
+		}
+		if (channelCount == 0 || sampleCount == 0)
+		{
+			std::cerr << "ParallelDecoder::decode(): " << path << " contains no samples\n";
+			return false;
+		}
+
+		// ranges shorter than a second are not worth a thread
+		if (threadCount == 0)
+		{
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		const sf::Uint64 minimumRange{ static_cast<sf::Uint64>(sampleRate) * channelCount };
+		threadCount = static_cast<unsigned int>(std::max<sf::Uint64>(std::min<sf::Uint64>(threadCount, sampleCount / minimumRange), 1));
+
+		// preallocate the output and split it into frame aligned ranges
+		samplesOut.resize(static_cast<std::size_t>(sampleCount));
+		std::vector<sf::Uint64> bounds(threadCount + 1);
+		for (unsigned int range{ 0 }; range < threadCount; ++range)
+		{
+			const sf::Uint64 frame{ sampleCount / channelCount * range / threadCount };
+			bounds[range] = frame * channelCount;
+		}
+		bounds[threadCount] = sampleCount;
+
+		// every range but the last also decodes the first samples of the next range
+		const sf::Uint64 checkCount{ s_checkFrames * channelCount };
+		std::vector<std::vector<sf::Int16>> checks(threadCount);
+		std::vector<char> results(threadCount, 0);
+		auto decodeTask = [&](unsigned int range)
+		{
+			const sf::Uint64 rangeCheck{ range + 1 < threadCount ? checkCount : 0 };
+			results[range] = decodeRange(path, bounds[range], bounds[range + 1], samplesOut.data() + bounds[range], checks[range], rangeCheck);
+		};
+
+		// the calling thread decodes the first range
+		std::vector<std::thread> threads;
+		for (unsigned int range{ 1 }; range < threadCount; ++range)
+		{
+			threads.emplace_back(decodeTask, range);
+		}
+		decodeTask(0);
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		// the samples decoded past each range must equal the samples the
+		// next range decoded after seeking, otherwise the stitch is not exact
+		bool exact{ std::find(results.begin(), results.end(), 0) == results.end() };
+		for (unsigned int range{ 0 }; exact && range + 1 < threadCount; ++range)
+		{
+			const std::vector<sf::Int16> &check{ checks[range] };
+			const sf::Uint64 nextLength{ bounds[range + 2] - bounds[range + 1] };
+			const std::size_t length{ static_cast<std::size_t>(std::min<sf::Uint64>(check.size(), nextLength)) };
+			exact = std::equal(check.begin(), check.begin() + length, samplesOut.begin() + static_cast<std::size_t>(bounds[range + 1]));
+		}
+
+		if (!exact)
+		{
+			std::cerr << "ParallelDecoder::decode(): inexact seek in " << path << ", decoding on one thread\n";
+			std::vector<sf::Int16> unused;
+			return decodeRange(path, 0, sampleCount, samplesOut.data(), unused, 0);
+		}
+		return true;
+	}
+}
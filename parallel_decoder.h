@@ -0,0 +1,47 @@
+#ifndef PARALLEL_DECODER_H
+#define PARALLEL_DECODER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <SFML/Audio.hpp>
+
+namespace ParallelDecoder
+{
+	/*
+		Reads samples from an open sound file in blocks, reporting the
+		amount read so far after every block.
+
+		file - sound file positioned at the first sample to read
+		dataOut - pointer to hold count samples
+		count - amount of interleaved samples to read
+		onBlock - optional callback receiving the amount of samples read
+		so far, returning false stops reading
+
+		Returns true when all samples were read and false on failure
+		or when stopped by the callback.
+	*/
+	bool readSamples(sf::InputSoundFile &file, sf::Int16* dataOut, sf::Uint64 count, const std::function<bool(sf::Uint64)> &onBlock = nullptr);
+
+	/*
+		Decodes an entire audio file into interleaved 16-bit samples.
+		The file is split into contiguous time ranges which are decoded
+		concurrently, each thread seeking its own sf::InputSoundFile to
+		the start of its range and writing into one preallocated buffer.
+		Every boundary is checked against a few samples decoded past the
+		end of the previous range; if a decoder did not seek sample-exactly
+		the file is decoded again on a single thread.
+
+		path - audio file to decode
+		samplesOut - vector to hold the decoded samples (resized to fit)
+		channelCount - receives the amount of channels
+		sampleRate - receives the sample rate in Hz
+		threadCount - amount of threads to use, 0 selects the
+		amount of hardware threads
+
+		Returns true on success and false on failure.
+	*/
+	bool decode(const std::string &path, std::vector<sf::Int16> &samplesOut, unsigned int &channelCount, unsigned int &sampleRate, unsigned int threadCount = 0);
+}
+
+#endif
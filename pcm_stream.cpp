@@ -0,0 +1,118 @@
+#include "pcm_stream.h"
+
+#include <algorithm>
+
+namespace
+{
+	// how often to check on a decoder that fell behind playback
+	const sf::Time s_readyPollInterval{ sf::milliseconds(5) };
+}
+
+// default constructor
+PcmStream::PcmStream()
+	: int16Samples{ nullptr }, floatSamples{ nullptr }, sampleCount{ 0 }, position{ 0 },
+	chunkSize{ 0 }, channelCount{ 0 }, sampleRate{ 0 }, readyCounter{ nullptr }, completeFlag{ nullptr },
+	waitCancelled{ false }
+{
+}
+
+// destructor, stops the streaming thread before members are destroyed
+PcmStream::~PcmStream()
+{
+	cancelWait();
+	stop();
+}
+
+// limit playback to the samples counted by ready while the source is still
+// being filled, until complete is set
+void PcmStream::setReadyCounter(const std::atomic<std::size_t>* ready, const std::atomic<bool>* complete)
+{
+	readyCounter = ready;
+	completeFlag = complete;
+}
+
+// stop waiting on the ready counter so a following stop() or seek does not
+// block until the decoder catches up, cleared again by the seek
+void PcmStream::cancelWait()
+{
+	waitCancelled = true;
+}
+
+// play 16-bit samples in place, memory must outlive playback
+void PcmStream::setSamples(const sf::Int16* samples, std::size_t sampleCount, unsigned int channelCount, unsigned int sampleRate)
+{
+	cancelWait();
+	stop();
+	int16Samples = samples;
+	floatSamples = nullptr;
+	this->sampleCount = sampleCount;
+	this->channelCount = channelCount;
+	this->sampleRate = sampleRate;
+	position = 0;
+	waitCancelled = false;
+	readyCounter = nullptr;
+	completeFlag = nullptr;
+
+	// 50 ms chunks keep device latency low without starving the stream thread
+	chunkSize = std::max<std::size_t>(sampleRate / 20, 1) * channelCount;
+	convertBuffer.clear();
+	initialize(channelCount, sampleRate);
+}
+
+// play float samples in the range [-1, 1], memory must outlive playback
+void PcmStream::setSamples(const float* samples, std::size_t sampleCount, unsigned int channelCount, unsigned int sampleRate)
+{
+	setSamples(static_cast<const sf::Int16*>(nullptr), sampleCount, channelCount, sampleRate);
+	floatSamples = samples;
+	convertBuffer.resize(chunkSize);
+}
+
+// supply the next chunk of samples
+bool PcmStream::onGetData(Chunk &data)
+{
+	std::size_t available{ sampleCount };
+	if (readyCounter)
+	{
+		// wait for a decoder that fell behind rather than ending the stream, which
+		// would loop back to the start. Only a finished decoder's count is final,
+		// so the flag is read before the counter. A cancelled wait hands over
+		// whatever is ready, the stream is about to be stopped or moved anyway
+		const std::size_t needed{ std::min(sampleCount, position + chunkSize) };
+		while (!waitCancelled && !completeFlag->load(std::memory_order_acquire) && readyCounter->load(std::memory_order_acquire) < needed)
+		{
+			sf::sleep(s_readyPollInterval);
+		}
+		available = std::min(readyCounter->load(std::memory_order_acquire), sampleCount);
+	}
+
+	const std::size_t count{ position < available ? std::min(chunkSize, available - position) : 0 };
+	if (count == 0)
+	{
+		return false;
+	}
+
+	if (floatSamples)
+	{
+		for (std::size_t x{ 0 }; x < count; ++x)
+		{
+			const float sample{ std::max(-1.0f, std::min(floatSamples[position + x], 1.0f)) };
+			convertBuffer[x] = static_cast<sf::Int16>(sample * 32767.0f);
+		}
+		data.samples = convertBuffer.data();
+	}
+	else
+	{
+		data.samples = int16Samples + position;
+	}
+	data.sampleCount = count;
+	position += count;
+	return true;
+}
+
+// move the read position
+void PcmStream::onSeek(sf::Time timeOffset)
+{
+	const std::size_t frame{ static_cast<std::size_t>(timeOffset.asMicroseconds()) * sampleRate / 1000000 };
+	position = std::min(frame * channelCount, sampleCount);
+	waitCancelled = false;
+}
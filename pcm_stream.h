@@ -0,0 +1,57 @@
+#ifndef PCM_STREAM_H
+#define PCM_STREAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include <SFML/Audio.hpp>
+
+/*
+	Sound stream that plays interleaved samples from memory owned by
+	someone else (a decoded buffer or a memory-mapped file). 16-bit
+	samples are handed to the audio device in place; float samples are
+	converted one chunk at a time.
+*/
+class PcmStream : public sf::SoundStream
+{
+public:
+	// default constructor
+	PcmStream();
+
+	// destructor, stops the streaming thread before members are destroyed
+	~PcmStream();
+
+	// play 16-bit samples in place, memory must outlive playback
+	void setSamples(const sf::Int16* samples, std::size_t sampleCount, unsigned int channelCount, unsigned int sampleRate);
+
+	// play float samples in the range [-1, 1], memory must outlive playback
+	void setSamples(const float* samples, std::size_t sampleCount, unsigned int channelCount, unsigned int sampleRate);
+
+	// limit playback to the samples counted by ready while the source is still
+	// being filled, until complete is set; nullptr means every sample is available
+	void setReadyCounter(const std::atomic<std::size_t>* ready, const std::atomic<bool>* complete);
+
+	// stop waiting on the ready counter so a following stop() or seek does not
+	// block until the decoder catches up, cleared again by the seek
+	void cancelWait();
+
+private:
+	bool onGetData(Chunk &data) override;			// supply the next chunk of samples
+	void onSeek(sf::Time timeOffset) override;		// move the read position
+
+	const sf::Int16* int16Samples;
+	const float* floatSamples;
+	std::size_t sampleCount;
+	std::size_t position;
+	std::size_t chunkSize;
+	unsigned int channelCount;
+	unsigned int sampleRate;
+	const std::atomic<std::size_t>* readyCounter;
+	const std::atomic<bool>* completeFlag;
+	std::atomic<bool> waitCancelled;
+
+	// holds converted samples of the current chunk for float sources
+	std::vector<sf::Int16> convertBuffer;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "playback_clock.h"
+
+#include <algorithm>
+#include <cmath>
+
+const double PlaybackClock::s_phaseGain{ 0.1 };
+const double PlaybackClock::s_rateGain{ 0.01 };
+const double PlaybackClock::s_maxRateError{ 0.005 };
+const double PlaybackClock::s_relockError{ 0.25 };
+const double PlaybackClock::s_maxLead{ 0.1 };
+
+// unlocked clock with no output latency
+PlaybackClock::PlaybackClock() : latency{ 0.0 }, locked{ false }, lastReported{ 0.0 }, anchorPosition{ 0.0 }, rate{ 1.0 }, position{ 0.0 }
+{
+}
+
+// set the output latency subtracted from the estimate
+void PlaybackClock::setLatency(double seconds)
+{
+	latency = std::max(seconds, 0.0);
+}
+
+// retrieve the output latency in seconds
+double PlaybackClock::getLatency() const
+{
+	return latency;
+}
+
+// forget the lock, the next update starts over at the reported offset
+void PlaybackClock::reset()
+{
+	locked = false;
+}
+
+// estimate the audible playing position at the current time
+double PlaybackClock::update(double reported, bool running)
+{
+	return update(reported, running, Clock::now());
+}
+
+// estimate the audible playing position at a given time
+double PlaybackClock::update(double reported, bool running, Clock::time_point now)
+{
+	typedef std::chrono::duration<double> Seconds;
+
+	if (!running || !locked)
+	{
+		// paused offsets are exact, and a running clock starts from the first one it sees
+		locked = running;
+		lastReported = reported;
+		lastUpdate = now;
+		anchorTime = now;
+		anchorPosition = reported;
+		rate = 1.0;
+		position = reported;
+		return std::max(position - latency, 0.0);
+	}
+
+	if (reported != lastReported)
+	{
+		// the device stepped somewhere between the previous update and now,
+		// compare at the midpoint so polling delay does not bias the lock
+		const Clock::time_point stepTime{ lastUpdate + (now - lastUpdate) / 2 };
+		const double predicted{ anchorPosition + rate * Seconds(stepTime - anchorTime).count() };
+		const double error{ reported - predicted };
+		if (std::abs(error) > s_relockError)
+		{
+			anchorTime = now;
+			anchorPosition = reported;
+			rate = 1.0;
+			position = reported;
+		}
+		else
+		{
+			anchorTime = stepTime;
+			anchorPosition = predicted + s_phaseGain * error;
+			rate = std::min(std::max(rate + s_rateGain * error, 1.0 - s_maxRateError), 1.0 + s_maxRateError);
+		}
+		lastReported = reported;
+	}
+	lastUpdate = now;
+
+	// a stalled device (underrun, slow decode) holds the estimate shortly after its
+	// offset, and small backward corrections hold the position instead of reversing it
+	const double estimate{ std::min(anchorPosition + rate * Seconds(now - anchorTime).count(), reported + s_maxLead) };
+	position = std::max(position, estimate);
+	return std::max(position - latency, 0.0);
+}
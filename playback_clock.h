@@ -0,0 +1,68 @@
+#ifndef PLAYBACK_CLOCK_H
+#define PLAYBACK_CLOCK_H
+
+#include <chrono>
+
+/*
+	Smooth estimate of the audible playing position. The offset reported
+	by the audio device only moves when it finishes a buffer or period,
+	so reading it every frame gives the same position for several frames
+	and then a jump. The clock extrapolates the position with a monotonic
+	timer and locks onto the reported offset like a PLL: every time the
+	offset moves, the phase error nudges the position and the rate, so
+	the estimate follows the device clock without copying its steps.
+
+	Output latency (the time from the reported offset to the speaker) is
+	subtracted from the estimate, so the analyzed window matches what is
+	being heard rather than what was last handed to the device.
+*/
+class PlaybackClock
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	// unlocked clock with no output latency
+	PlaybackClock();
+
+	void setLatency(double seconds);	// set the output latency subtracted from the estimate
+	double getLatency() const;			// retrieve the output latency in seconds
+
+	// forget the lock, the next update starts over at the reported offset (after a seek or stop)
+	void reset();
+
+	/*
+		Estimates the audible playing position.
+
+		reported - playing offset reported by the device in seconds
+		running - whether the sound is playing, paused sounds return the reported offset
+		now - time of the call
+
+		Returns the estimated position in seconds, never below zero.
+	*/
+	double update(double reported, bool running);
+	double update(double reported, bool running, Clock::time_point now);
+
+private:
+	// fractions of the phase error corrected per device step, in position and in rate
+	static const double s_phaseGain;
+	static const double s_rateGain;
+
+	// largest deviation of the rate from real time, and the error that
+	// is treated as a discontinuity (seek, loop, underrun) instead of drift
+	static const double s_maxRateError;
+	static const double s_relockError;
+
+	// how far the estimate may run ahead of a reported offset that stopped moving
+	static const double s_maxLead;
+
+	double latency;
+	bool locked;
+	double lastReported;			// reported offset of the previous update
+	Clock::time_point lastUpdate;	// time of the previous update
+	Clock::time_point anchorTime;	// time the position was last corrected
+	double anchorPosition;			// estimated position at anchorTime
+	double rate;					// playback seconds per real second
+	double position;				// last returned estimate before latency, kept monotonic
+};
+
+#endif
@@ -0,0 +1,292 @@
+#include "progressive_decoder.h"
+#include "parallel_decoder.h"
+
+#include <iostream>
+#include <algorithm>
+
+namespace
+{
+	// amount of sample frames decoded past the end of a range to verify the next boundary
+	const sf::Uint64 s_checkFrames{ 256 };
+}
+
+// default constructor
+ProgressiveDecoder::ProgressiveDecoder()
+	: channelCount{ 0 }, sampleRate{ 0 }, verifiedRanges{ 0 }, failedRange{ 0 },
+	readyCount{ 0 }, complete{ false }, cancelled{ false }
+{
+}
+
+// destructor, stops background decoding
+ProgressiveDecoder::~ProgressiveDecoder()
+{
+	cancelled = true;
+	wait();
+}
+
+// decodes the first initialSeconds of a file and starts decoding the rest in the background
+bool ProgressiveDecoder::open(const std::string &path, float initialSeconds, unsigned int threadCount)
+{
+	if (!firstFile.openFromFile(path))
+	{
+		std::cerr << "ProgressiveDecoder::open(): unable to open " << path << '\n';
+		return false;
+	}
+	this->path = path;
+	channelCount = firstFile.getChannelCount();
+	sampleRate = firstFile.getSampleRate();
+	const sf::Uint64 sampleCount{ firstFile.getSampleCount() };
+	if (channelCount == 0 || sampleCount == 0)
+	{
+		std::cerr << "ProgressiveDecoder::open(): " << path << " contains no samples\n";
+		return false;
+	}
+
+	// ranges shorter than a second are not worth a thread
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	const sf::Uint64 minimumRange{ static_cast<sf::Uint64>(sampleRate) * channelCount };
+	const unsigned int rangeCount{ static_cast<unsigned int>(std::max<sf::Uint64>(std::min<sf::Uint64>(threadCount, sampleCount / minimumRange), 1)) };
+
+	// preallocate the output and split it into frame aligned ranges
+	samples.resize(static_cast<std::size_t>(sampleCount));
+	bounds.resize(rangeCount + 1);
+	for (unsigned int range{ 0 }; range < rangeCount; ++range)
+	{
+		bounds[range] = sampleCount / channelCount * range / rangeCount * channelCount;
+	}
+	bounds[rangeCount] = sampleCount;
+	progress.assign(rangeCount, 0);
+	checks.assign(rangeCount, std::vector<sf::Int16>());
+	checkComplete.assign(rangeCount, 0);
+	verifiedRanges = 1;
+	failedRange = rangeCount;
+
+	// decode the start of the file before returning
+	const sf::Uint64 initialFrames{ static_cast<sf::Uint64>(std::max(initialSeconds, 0.0f) * sampleRate) };
+	const sf::Uint64 initialCount{ std::min(initialFrames * channelCount, bounds[1]) };
+	if (!ParallelDecoder::readSamples(firstFile, samples.data(), initialCount))
+	{
+		std::cerr << "ProgressiveDecoder::open(): unable to decode the start of " << path << '\n';
+		return false;
+	}
+	publish(0, initialCount);
+
+	if (initialCount == sampleCount)
+	{
+		complete = true;
+	}
+	else
+	{
+		loader = std::thread(&ProgressiveDecoder::decodeInBackground, this);
+	}
+	return true;
+}
+
+// decode remaining ranges and repair inexact stitches
+void ProgressiveDecoder::decodeInBackground()
+{
+	const unsigned int rangeCount{ static_cast<unsigned int>(bounds.size() - 1) };
+	std::vector<std::thread> workers;
+	for (unsigned int range{ 1 }; range < rangeCount; ++range)
+	{
+		workers.emplace_back(&ProgressiveDecoder::decodeRange, this, range);
+	}
+
+	// the first range continues sequentially from the initial samples
+	const sf::Uint64 initialCount{ progress[0] };
+	const bool firstDecoded{ ParallelDecoder::readSamples(firstFile, samples.data() + initialCount, bounds[1] - initialCount,
+		[this, initialCount](sf::Uint64 read) { return publish(0, initialCount + read); }) };
+	if (firstDecoded && rangeCount > 1)
+	{
+		readCheck(firstFile, 0);
+	}
+
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+
+	unsigned int failed;
+	{
+		std::lock_guard<std::mutex> lock(progressMutex);
+		failed = firstDecoded ? failedRange : 0;
+	}
+
+	// decode everything after the verified prefix on this thread,
+	// skipping over the samples that are already usable
+	if (failed < rangeCount && !cancelled)
+	{
+		std::cerr << "ProgressiveDecoder::decodeInBackground(): inexact seek in " << path << ", decoding the rest on one thread\n";
+		sf::InputSoundFile file;
+		if (file.openFromFile(path))
+		{
+			const sf::Uint64 start{ readyCount.load(std::memory_order_acquire) };
+			std::vector<sf::Int16> skipped(static_cast<std::size_t>(std::min<sf::Uint64>(start, 65536)));
+			sf::Uint64 position{ 0 };
+			while (position < start && !cancelled)
+			{
+				const sf::Uint64 read{ file.read(skipped.data(), std::min<sf::Uint64>(skipped.size(), start - position)) };
+				if (read == 0)
+				{
+					break;
+				}
+				position += read;
+			}
+			if (position == start)
+			{
+				ParallelDecoder::readSamples(file, samples.data() + start, bounds[rangeCount] - start,
+					[this, start](sf::Uint64 read)
+				{
+					readyCount.store(static_cast<std::size_t>(start + read), std::memory_order_release);
+					return !cancelled;
+				});
+			}
+		}
+	}
+
+	complete = true;
+}
+
+// decode one range followed by the start of the next
+void ProgressiveDecoder::decodeRange(unsigned int range)
+{
+	const sf::Uint64 length{ bounds[range + 1] - bounds[range] };
+	sf::InputSoundFile file;
+	bool decoded{ file.openFromFile(path) };
+	if (decoded)
+	{
+		file.seek(bounds[range]);
+		decoded = ParallelDecoder::readSamples(file, samples.data() + bounds[range], length,
+			[this, range](sf::Uint64 read) { return publish(range, read); });
+	}
+	if (!decoded)
+	{
+		std::lock_guard<std::mutex> lock(progressMutex);
+		failedRange = std::min(failedRange, range);
+		return;
+	}
+
+	if (range + 2 < bounds.size())
+	{
+		readCheck(file, range);
+	}
+}
+
+// decode the samples past the end of a completed range
+void ProgressiveDecoder::readCheck(sf::InputSoundFile &file, unsigned int range)
+{
+	// the end of the file may cut the check short
+	std::vector<sf::Int16> &check{ checks[range] };
+	check.resize(static_cast<std::size_t>(s_checkFrames * channelCount));
+	sf::Uint64 checked{ 0 };
+	while (checked < check.size())
+	{
+		const sf::Uint64 read{ file.read(check.data() + checked, check.size() - checked) };
+		if (read == 0)
+		{
+			break;
+		}
+		checked += read;
+	}
+	check.resize(static_cast<std::size_t>(checked));
+	{
+		std::lock_guard<std::mutex> lock(progressMutex);
+		checkComplete[range] = 1;
+	}
+	publish(range, bounds[range + 1] - bounds[range]);
+}
+
+// record progress and advance the ready prefix, returns false when cancelled
+bool ProgressiveDecoder::publish(unsigned int range, sf::Uint64 decoded)
+{
+	std::lock_guard<std::mutex> lock(progressMutex);
+	progress[range] = decoded;
+
+	// a range becomes usable once the range before it is complete and the
+	// samples decoded past its end match the start of this range
+	const unsigned int rangeCount{ static_cast<unsigned int>(bounds.size() - 1) };
+	while (verifiedRanges < rangeCount && verifiedRanges < failedRange)
+	{
+		const unsigned int previous{ verifiedRanges - 1 };
+		if (progress[previous] < bounds[verifiedRanges] - bounds[previous] || !checkComplete[previous])
+		{
+			break;
+		}
+		const std::vector<sf::Int16> &check{ checks[previous] };
+		const std::size_t length{ static_cast<std::size_t>(std::min<sf::Uint64>(check.size(), bounds[verifiedRanges + 1] - bounds[verifiedRanges])) };
+		if (progress[verifiedRanges] < length)
+		{
+			break;
+		}
+		if (!std::equal(check.begin(), check.begin() + length, samples.begin() + static_cast<std::size_t>(bounds[verifiedRanges])))
+		{
+			failedRange = verifiedRanges;
+			break;
+		}
+		++verifiedRanges;
+	}
+
+	const unsigned int last{ verifiedRanges - 1 };
+	readyCount.store(static_cast<std::size_t>(bounds[last] + progress[last]), std::memory_order_release);
+	return !cancelled;
+}
+
+// retrieve the preallocated sample buffer
+const sf::Int16* ProgressiveDecoder::getSamples() const
+{
+	return samples.data();
+}
+
+// retrieve the amount of samples in the file
+std::size_t ProgressiveDecoder::getSampleCount() const
+{
+	return samples.size();
+}
+
+// retrieve the amount of samples decoded from the start
+std::size_t ProgressiveDecoder::getReadyCount() const
+{
+	return readyCount.load(std::memory_order_acquire);
+}
+
+// retrieve the counter behind getReadyCount()
+const std::atomic<std::size_t>* ProgressiveDecoder::getReadyCounter() const
+{
+	return &readyCount;
+}
+
+// retrieve whether the whole file is decoded
+bool ProgressiveDecoder::isComplete() const
+{
+	return complete;
+}
+
+// retrieve the flag behind isComplete()
+const std::atomic<bool>* ProgressiveDecoder::getCompleteFlag() const
+{
+	return &complete;
+}
+
+// block until background decoding has finished
+void ProgressiveDecoder::wait()
+{
+	if (loader.joinable())
+	{
+		loader.join();
+	}
+}
+
+// retrieve the amount of channels
+unsigned int ProgressiveDecoder::getChannelCount() const
+{
+	return channelCount;
+}
+
+// retrieve sample rate in Hz
+unsigned int ProgressiveDecoder::getSampleRate() const
+{
+	return sampleRate;
+}
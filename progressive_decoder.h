@@ -0,0 +1,74 @@
+#ifndef PROGRESSIVE_DECODER_H
+#define PROGRESSIVE_DECODER_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SFML/Audio.hpp>
+
+/*
+	Decodes a compressed audio file while it is being played. The first
+	few seconds are decoded before open() returns; the rest is split into
+	time ranges decoded concurrently in the background, as done by
+	ParallelDecoder. Consumers read the samples in [0, getReadyCount()),
+	a prefix that only grows and never contains an unverified stitch.
+*/
+class ProgressiveDecoder
+{
+public:
+	// default constructor
+	ProgressiveDecoder();
+
+	// destructor, stops background decoding
+	~ProgressiveDecoder();
+
+	ProgressiveDecoder(const ProgressiveDecoder &) = delete;
+	ProgressiveDecoder &operator=(const ProgressiveDecoder &) = delete;
+
+	// decodes the first initialSeconds of a file and starts decoding the
+	// rest in the background, threadCount 0 selects the amount of hardware threads
+	bool open(const std::string &path, float initialSeconds, unsigned int threadCount = 0);
+
+	const sf::Int16* getSamples() const;		// retrieve the preallocated sample buffer
+	std::size_t getSampleCount() const;			// retrieve the amount of samples in the file
+	std::size_t getReadyCount() const;			// retrieve the amount of samples decoded from the start
+	const std::atomic<std::size_t>* getReadyCounter() const;	// retrieve the counter behind getReadyCount()
+	bool isComplete() const;					// retrieve whether the whole file is decoded
+	const std::atomic<bool>* getCompleteFlag() const;	// retrieve the flag behind isComplete()
+	void wait();								// block until background decoding has finished
+	unsigned int getChannelCount() const;		// retrieve the amount of channels
+	unsigned int getSampleRate() const;			// retrieve sample rate in Hz
+
+private:
+	void decodeInBackground();					// decode remaining ranges and repair inexact stitches
+	void decodeRange(unsigned int range);		// decode one range followed by the start of the next
+	void readCheck(sf::InputSoundFile &file, unsigned int range);	// decode the samples past the end of a completed range
+	bool publish(unsigned int range, sf::Uint64 decoded);	// record progress and advance the ready prefix
+
+	std::string path;
+	unsigned int channelCount;
+	unsigned int sampleRate;
+	std::vector<sf::Int16> samples;
+
+	// ranges are [bounds[r], bounds[r + 1]), progress counts samples
+	// decoded in each range and checks hold the samples decoded past it
+	std::vector<sf::Uint64> bounds;
+	std::vector<sf::Uint64> progress;
+	std::vector<std::vector<sf::Int16>> checks;
+	std::vector<char> checkComplete;
+	unsigned int verifiedRanges;
+	unsigned int failedRange;
+	std::mutex progressMutex;
+
+	std::atomic<std::size_t> readyCount;
+	std::atomic<bool> complete;
+	std::atomic<bool> cancelled;
+
+	sf::InputSoundFile firstFile;
+	std::thread loader;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "quality_governor.h"
+
+#include <algorithm>
+
+// cheapest first, the default 8192 point FFT every frame is level 3
+const QualityGovernor::Level QualityGovernor::s_levels[]
+{
+	{ 1024, 3, 1 },
+	{ 2048, 2, 2 },
+	{ 4096, 1, 4 },
+	{ 8192, 1, 8 },
+	{ 16384, 1, 16 }
+};
+
+const int QualityGovernor::s_windowFrames{ 60 };
+const double QualityGovernor::s_highLoad{ 0.8 };
+const double QualityGovernor::s_lowLoad{ 0.3 };
+const int QualityGovernor::s_calmWindows{ 3 };
+
+// start at a level, aiming for frames of budgetMilliseconds
+QualityGovernor::QualityGovernor(double budgetMilliseconds, int level)
+	: budget{ budgetMilliseconds }, level{ std::min(std::max(level, 0), getLevelCount() - 1) },
+	maxLevel{ getLevelCount() - 1 }, enabled{ true },
+	frames{ 0 }, analysisSum{ 0.0 }, renderSum{ 0.0 }, calmCount{ 0 }
+{
+}
+
+// set the frame time budget
+void QualityGovernor::setBudget(double budgetMilliseconds)
+{
+	budget = budgetMilliseconds;
+}
+
+// retrieve the frame time budget in milliseconds
+double QualityGovernor::getBudget() const
+{
+	return budget;
+}
+
+// set whether record() changes levels
+void QualityGovernor::setEnabled(bool enabled)
+{
+	this->enabled = enabled;
+	frames = 0;
+	analysisSum = 0.0;
+	renderSum = 0.0;
+	calmCount = 0;
+}
+
+// retrieve whether record() changes levels
+bool QualityGovernor::isEnabled() const
+{
+	return enabled;
+}
+
+// set the highest level record() steps up to, a lower current level is kept
+void QualityGovernor::setMaxLevel(int level)
+{
+	maxLevel = std::min(std::max(level, 0), getLevelCount() - 1);
+}
+
+// add the measured times of one frame, returns true if the level changed
+bool QualityGovernor::record(double analysisMilliseconds, double renderMilliseconds)
+{
+	if (!enabled)
+	{
+		return false;
+	}
+
+	analysisSum += analysisMilliseconds;
+	renderSum += renderMilliseconds;
+	if (++frames < s_windowFrames)
+	{
+		return false;
+	}
+
+	// the threads run side by side, so the busier one decides
+	const double load{ std::max(analysisSum, renderSum) / frames / budget };
+	frames = 0;
+	analysisSum = 0.0;
+	renderSum = 0.0;
+
+	int next{ level };
+	if (load > s_highLoad)
+	{
+		next = std::max(level - 1, 0);
+		calmCount = 0;
+	}
+	else if (load < s_lowLoad && ++calmCount >= s_calmWindows)
+	{
+		next = std::max(std::min(level + 1, maxLevel), level);
+		calmCount = 0;
+	}
+	else if (load >= s_lowLoad)
+	{
+		calmCount = 0;
+	}
+
+	if (next == level)
+	{
+		return false;
+	}
+	level = next;
+	return true;
+}
+
+// retrieve the settings of the current level
+const QualityGovernor::Level &QualityGovernor::getLevel() const
+{
+	return s_levels[level];
+}
+
+// retrieve the current level, 0 is the cheapest
+int QualityGovernor::getLevelIndex() const
+{
+	return level;
+}
+
+// retrieve the amount of levels
+int QualityGovernor::getLevelCount()
+{
+	return static_cast<int>(sizeof(s_levels) / sizeof(s_levels[0]));
+}
+
+// retrieve the settings of a level
+const QualityGovernor::Level &QualityGovernor::getLevel(int index)
+{
+	return s_levels[index];
+}
@@ -0,0 +1,68 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+/*
+	Picks the analysis and drawing quality that fits a frame time budget.
+	Levels range from a small FFT analyzed every few frames with straight
+	curves up to a large FFT analyzed every frame with finely subdivided
+	curves; each step roughly doubles the work.
+
+	The governor averages the measured analysis and render times over a
+	window of frames and compares the busier of the two threads with the
+	budget. It steps down as soon as one window runs over the high mark,
+	but only steps up after several windows in a row stayed under the low
+	mark, so a level that just fits does not oscillate.
+*/
+class QualityGovernor
+{
+public:
+	struct Level
+	{
+		int fftSize;		// samples per transform
+		int hopFrames;		// displayed frames per transform
+		int subdivisions;	// curve segments per band
+	};
+
+	// start at a level, aiming for frames of budgetMilliseconds
+	QualityGovernor(double budgetMilliseconds, int level);
+
+	void setBudget(double budgetMilliseconds);	// set the frame time budget
+	double getBudget() const;					// retrieve the frame time budget in milliseconds
+	void setEnabled(bool enabled);				// set whether record() changes levels
+	bool isEnabled() const;						// retrieve whether record() changes levels
+	void setMaxLevel(int level);				// set the highest level record() steps up to
+
+	/*
+		Adds the measured times of one displayed frame.
+
+		analysisMilliseconds - time the event thread spent analyzing per frame
+		renderMilliseconds - time the render thread spent updating and drawing
+
+		Returns true if the level changed.
+	*/
+	bool record(double analysisMilliseconds, double renderMilliseconds);
+
+	const Level &getLevel() const;			// retrieve the settings of the current level
+	int getLevelIndex() const;				// retrieve the current level, 0 is the cheapest
+
+	static int getLevelCount();				// retrieve the amount of levels
+	static const Level &getLevel(int index);	// retrieve the settings of a level
+
+private:
+	static const Level s_levels[];
+	static const int s_windowFrames;		// frames averaged per decision
+	static const double s_highLoad;			// fraction of the budget that steps down
+	static const double s_lowLoad;			// fraction of the budget that allows stepping up
+	static const int s_calmWindows;			// windows under the low mark before stepping up
+
+	double budget;
+	int level;
+	int maxLevel;
+	bool enabled;
+	int frames;
+	double analysisSum;
+	double renderSum;
+	int calmCount;
+};
+
+#endif
@@ -0,0 +1,308 @@
+#include "render_thread.h"
+#include "spectrum.h"
+#include "waterfall.h"
+#include "scene.h"
+#include "window.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "gpu_timer.h"
+#include "alloc_counter.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+// sourceCount arrays of bandCount levels per snapshot, the first one is the mixed
+// signal; the window's context must not be active on the calling thread
+RenderThread::RenderThread(sf::Window &window, int bandCount, int sourceCount)
+	: window(window), bandCount{ bandCount }, sourceCount{ sourceCount }, running{ false }, presentedCount{ 0 }, renderTime{ 0.0f },
+	writeIndex{ 0 }, readyIndex{ 1 }, readIndex{ 2 }, fresh{ false }
+{
+	for (auto &snapshot : snapshots)
+	{
+		snapshot.levels.assign(static_cast<std::size_t>(bandCount) * sourceCount, 0.0f);
+		snapshot.playing = false;
+	}
+}
+
+// stops the thread if still running
+RenderThread::~RenderThread()
+{
+	stop();
+}
+
+// create GL objects and start rendering on the render thread
+void RenderThread::start()
+{
+	if (!thread.joinable())
+	{
+		running = true;
+		thread = std::thread(&RenderThread::run, this);
+	}
+}
+
+// finish the current frame, release GL objects and join
+void RenderThread::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	workAvailable.notify_one();
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+}
+
+// queue a command for the next frame
+void RenderThread::post(RenderCommand command)
+{
+	command.sent = Clock::now();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		commands.push_back(command);
+	}
+	workAvailable.notify_one();
+}
+
+// publish sourceCount * bandCount levels as the newest snapshot, playing adds them to waterfalls
+void RenderThread::publish(const GLfloat* levels, bool playing)
+{
+	// fill the write slot outside the lock, only the render thread's slot is in use elsewhere
+	Snapshot &snapshot{ snapshots[writeIndex] };
+	std::copy(levels, levels + snapshot.levels.size(), snapshot.levels.begin());
+	snapshot.playing = playing;
+	snapshot.published = Clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::swap(writeIndex, readyIndex);
+		fresh = true;
+	}
+	workAvailable.notify_one();
+}
+
+// wait until the render thread took the newest snapshot or timeout passed,
+// returns true if it was taken (or the thread stopped)
+bool RenderThread::waitForConsumer(std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	return snapshotTaken.wait_for(lock, timeout, [this]() { return !fresh || !running; });
+}
+
+// retrieve whether a frame has been displayed yet
+bool RenderThread::hasPresented() const
+{
+	return presentedCount > 0;
+}
+
+// retrieve the amount of frames displayed so far
+std::size_t RenderThread::getPresentedCount() const
+{
+	return presentedCount;
+}
+
+// retrieve the update and draw time of the last frame in milliseconds
+float RenderThread::getRenderTime() const
+{
+	return renderTime;
+}
+
+// render loop of the thread
+void RenderThread::run()
+{
+	window.setActive(true);
+	{
+		// GL objects live in this scope, so they are released while the context is still active
+		Spectrum spectrum(bandCount, 1.0f);
+		Waterfall waterfall(bandCount, 512, 75.0f, 100.0f, Window::width - 150.0f, 600.0f);
+		waterfall.setScale(600.0f);
+		bool showWaterfall{ false };
+
+		// split layout: the mix as bars next to its history, and every other
+		// source as a filled curve below, three draws for all of them
+		Scene scene(bandCount, sourceCount, 600.0f);
+		const GLfloat half{ (Window::width - 60.0f) / 2.0f };
+		const GLfloat rowHeight{ (Window::height - 60.0f) / 2.0f };
+		scene.addView(Scene::Bars, 0, { 20.0f, rowHeight + 40.0f, half, rowHeight });
+		scene.addView(Scene::History, 0, { half + 40.0f, rowHeight + 40.0f, half, rowHeight });
+		const GLfloat channelWidth{ (Window::width - 20.0f) / std::max(sourceCount - 1, 1) - 20.0f };
+		for (int source{ 1 }; source < sourceCount; ++source)
+		{
+			scene.addView(Scene::Area, source, { 20.0f + (source - 1) * (channelWidth + 20.0f), 20.0f, channelWidth, rowHeight });
+		}
+		bool showScene{ false };
+
+		// frame pacing and timing of every render stage, dumped once per second when enabled
+		FramePacer pacer(window, 60);
+		FrameStats stats;
+		const int commandSection{ stats.addSection("input latency") };
+		const int updateSection{ stats.addSection("spectrum update") };
+		const int drawSection{ stats.addSection("draw") };
+		const int gpuSection{ stats.addSection("draw (gpu)") };
+		const int latencySection{ stats.addSection("render latency") };
+		const int frameSection{ stats.addSection("frame") };
+		GpuTimer drawTimer;
+		bool dumpStats{ false };
+		Clock::time_point lastDump{ Clock::now() };
+		std::size_t dumpedAllocations{ 0 };
+		std::deque<RenderCommand> pending;
+
+		while (true)
+		{
+			// sleep until there is something new to show, an unchanged frame is not drawn again
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				workAvailable.wait(lock, [this]() { return fresh || !commands.empty() || !running; });
+			}
+			if (!running)
+			{
+				break;
+			}
+			ScopedTimer frameTimer(stats, frameSection);
+
+			// wait for the frame deadline first, so commands and the snapshot
+			// are taken as late as possible before drawing
+			pacer.wait();
+
+			// apply commands in the order they were sent. Views only receive levels
+			// while shown, so one that becomes visible or changes how it packs
+			// levels gets the current snapshot again
+			bool viewChanged{ false };
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				pending.swap(commands);
+			}
+			for (const auto &command : pending)
+			{
+				stats.record(commandSection, std::chrono::duration<double, std::milli>(Clock::now() - command.sent).count());
+				switch (command.type)
+				{
+				case RenderCommand::Viewport:
+					glViewport(command.x, command.y, command.width, command.height);
+					spectrum.setViewport(command.width, command.height);
+					viewChanged = true;
+					break;
+				case RenderCommand::RenderMode:
+					spectrum.setMode(static_cast<Spectrum::Mode>(command.value));
+					break;
+				case RenderCommand::Aggregate:
+					spectrum.setAggregate(static_cast<Spectrum::Aggregate>(command.value));
+					viewChanged = true;
+					break;
+				case RenderCommand::Subdivisions:
+					spectrum.setSubdivisions(command.value);
+					break;
+				case RenderCommand::ShowWaterfall:
+					showWaterfall = command.value != 0;
+					viewChanged = true;
+					break;
+				case RenderCommand::Pacing:
+					pacer.setMode(static_cast<FramePacer::Mode>(command.value));
+					break;
+				case RenderCommand::DumpStats:
+					dumpStats = command.value != 0;
+					lastDump = Clock::now();
+					break;
+				case RenderCommand::Layout:
+					showScene = command.value != 0;
+					viewChanged = true;
+					break;
+				case RenderCommand::Redraw:
+					break;
+				}
+			}
+			pending.clear();
+
+			// take the newest snapshot, if one arrived since the last frame
+			bool newSnapshot{ false };
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (fresh)
+				{
+					std::swap(readIndex, readyIndex);
+					fresh = false;
+					newSnapshot = true;
+				}
+			}
+			if (newSnapshot)
+			{
+				snapshotTaken.notify_one();
+			}
+			const Snapshot &snapshot{ snapshots[readIndex] };
+
+			// history keeps scrolling while other views are shown
+			if (newSnapshot && snapshot.playing)
+			{
+				waterfall.addRow(snapshot.levels.data());
+			}
+			if (newSnapshot || viewChanged)
+			{
+				ScopedTimer updateTimer(stats, updateSection);
+				if (showScene)
+				{
+					scene.update(snapshot.levels.data(), newSnapshot && snapshot.playing);
+				}
+				else if (!showWaterfall)
+				{
+					spectrum.update(snapshot.levels.data());
+				}
+			}
+
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			// gpu results arrive a few frames later, collect whatever has finished
+			drawTimer.collect(stats, gpuSection);
+			{
+				ScopedTimer drawCpuTimer(stats, drawSection);
+				drawTimer.begin();
+				if (showScene)
+				{
+					scene.draw();
+				}
+				else if (showWaterfall)
+				{
+					waterfall.draw();
+				}
+				else
+				{
+					spectrum.draw();
+				}
+				drawTimer.end();
+			}
+
+			window.display();
+			++presentedCount;
+			const double updateTime{ newSnapshot || viewChanged ? stats.getLatest(updateSection) : 0.0 };
+			renderTime = static_cast<float>(updateTime + std::max(stats.getLatest(drawSection), stats.getLatest(gpuSection)));
+			if (newSnapshot)
+			{
+				stats.record(latencySection, std::chrono::duration<double, std::milli>(Clock::now() - snapshot.published).count());
+			}
+
+			if (dumpStats && Clock::now() - lastDump >= std::chrono::seconds(1))
+			{
+				// one write, so lines of the event thread's dump do not interleave
+				std::ostringstream dump;
+				dump << "Render timing (" << FramePacer::getModeName(pacer.getMode()) << ", last "
+					<< stats.getSummary(frameSection).count << " frames)\n";
+				stats.print(dump);
+				if (AllocationCounter::isEnabled())
+				{
+					dump << AllocationCounter::getThreadCount() - dumpedAllocations << " heap allocations since the last dump\n";
+				}
+				dump << '\n';
+				std::cout << dump.str() << std::flush;
+				lastDump = Clock::now();
+				dumpedAllocations = AllocationCounter::getThreadCount();
+			}
+		}
+	}
+	window.setActive(false);
+
+	// wake an event thread waiting for a snapshot that will never be taken
+	snapshotTaken.notify_all();
+}
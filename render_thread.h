@@ -0,0 +1,126 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <glad/glad.h>
+#include <SFML/Window.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// small immutable request from the event thread to the render thread
+struct RenderCommand
+{
+	enum Type
+	{
+		Viewport,		// x, y, width, height of the letterboxed viewport
+		RenderMode,		// value is a Spectrum::Mode
+		Aggregate,		// value is a Spectrum::Aggregate
+		Subdivisions,	// value is the amount of curve points per bar
+		ShowWaterfall,	// value is nonzero to show the waterfall instead of the spectrum
+		Pacing,			// value is a FramePacer::Mode
+		DumpStats,		// value is nonzero to print render timing once per second
+		Layout,			// value is nonzero to show every source side by side in a scene
+		Redraw			// draw the current snapshot again, e.g. after the window was uncovered
+	};
+
+	Type type;
+	int value;
+	int x, y, width, height;
+	std::chrono::steady_clock::time_point sent;		// filled in by post()
+};
+
+/*
+	Owns the window's OpenGL context and every GL object on a thread of
+	its own, so event handling and analysis never wait for the driver and
+	a slow frame never delays input.
+
+	The event thread hands over two things: commands, which are queued and
+	applied in order at the start of the next frame, and spectrum
+	snapshots. Snapshots are latest-value only and triple buffered, so
+	publishing never blocks on rendering and the render thread always
+	draws the newest levels without copying under the lock.
+
+	Frames are only drawn when something changed: with no new snapshot
+	and no command the render thread sleeps instead of redrawing the same
+	image, so a paused visualizer costs no GPU or CPU time.
+
+	The render thread times its own stages, the delay of commands
+	(input latency) and the time from publishing a snapshot to the frame
+	showing it being displayed (render latency).
+*/
+class RenderThread
+{
+public:
+	// sourceCount arrays of bandCount levels per snapshot, the first one is the mixed
+	// signal; the window's context must not be active on the calling thread
+	RenderThread(sf::Window &window, int bandCount, int sourceCount);
+
+	// stops the thread if still running
+	~RenderThread();
+
+	RenderThread(const RenderThread &) = delete;
+	RenderThread &operator=(const RenderThread &) = delete;
+
+	void start();							// create GL objects and start rendering on the render thread
+	void stop();							// finish the current frame, release GL objects and join
+
+	void post(RenderCommand command);		// queue a command for the next frame
+
+	// publish sourceCount * bandCount levels as the newest snapshot, playing adds them to waterfalls
+	void publish(const GLfloat* levels, bool playing);
+
+	// wait until the render thread took the newest snapshot or timeout passed,
+	// returns true if it was taken (or the thread stopped)
+	bool waitForConsumer(std::chrono::milliseconds timeout);
+
+	// retrieve whether a frame has been displayed yet
+	bool hasPresented() const;
+
+	// retrieve the amount of frames displayed so far
+	std::size_t getPresentedCount() const;
+
+	// retrieve the update and draw time of the last frame in milliseconds,
+	// the slower of the CPU and GPU side of the draw
+	float getRenderTime() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Snapshot
+	{
+		std::vector<GLfloat> levels;
+		bool playing;
+		Clock::time_point published;
+	};
+
+	void run();								// render loop of the thread
+
+	sf::Window &window;
+	const int bandCount;
+	const int sourceCount;
+
+	std::thread thread;
+	std::atomic<bool> running;
+	std::atomic<std::size_t> presentedCount;
+	std::atomic<float> renderTime;
+
+	// guards commands and the snapshot indices
+	std::mutex mutex;
+	std::condition_variable snapshotTaken;
+	std::condition_variable workAvailable;	// signalled by post(), publish() and stop()
+	std::deque<RenderCommand> commands;
+
+	// snapshots[writeIndex] is filled by publish(), snapshots[readIndex] is
+	// drawn, and the third is the newest finished one waiting to be taken
+	Snapshot snapshots[3];
+	int writeIndex;
+	int readyIndex;
+	int readIndex;
+	bool fresh;			// whether snapshots[readyIndex] was published since the last take
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef SAMPLE_KERNEL_H
+#define SAMPLE_KERNEL_H
+
+#include <cstddef>
+#include <complex>
+#include <vector>
+
+/*
+	Per sample loops feeding the FFT: downmixing interleaved channels,
+	scaling to a common range and applying the analysis window. T is the
+	sample type of the source (16-bit integers or floats).
+*/
+namespace SampleKernel
+{
+	// downmix interleaved samples to mono and scale them
+	template <typename T>
+	void downmixSamples(const T* samples, int channelCount, double scale, std::size_t length, double* dataOut)
+	{
+		for (std::size_t x{ 0 }, y{ 0 }; y < length; x += channelCount, ++y)
+		{
+			double sampleSum{ 0.0 };
+			for (int channel{ 0 }; channel < channelCount; ++channel)
+			{
+				sampleSum += samples[x + channel];
+			}
+			dataOut[y] = sampleSum * scale / channelCount;
+		}
+	}
+
+	// pick one channel of interleaved samples, scale it and apply a window
+	template <typename T>
+	void windowChannel(const T* samples, int channelCount, int channel, double scale, const std::vector<double> &window, std::vector<std::complex<double>> &dataOut)
+	{
+		const std::size_t length{ window.size() };
+		for (std::size_t x{ static_cast<std::size_t>(channel) }, y{ 0 }; y < length; x += channelCount, ++y)
+		{
+			dataOut[y] = samples[x] * scale * window[y];
+		}
+	}
+
+	// downmix interleaved samples to mono, scale them and apply a window
+	template <typename T>
+	void windowSamples(const T* samples, int channelCount, double scale, const std::vector<double> &window, std::vector<std::complex<double>> &dataOut)
+	{
+		const std::size_t length{ window.size() };
+		// check for stereo input
+		if (channelCount == 2)
+		{
+			for (std::size_t x{ 0 }, y{ 0 }; y < length; x += 2, ++y)
+			{
+				// average stereo data: left and right samples are interleaved
+				double sampleAverage{ (samples[x] + samples[x + 1]) * scale / 2.0 };
+				dataOut[y] = sampleAverage * window[y];
+			}
+		}
+		else
+		{
+			for (std::size_t x{ 0 }, y{ 0 }; y < length; x += channelCount, ++y)
+			{
+				double sampleSum{ 0.0 };
+				for (int channel{ 0 }; channel < channelCount; ++channel)
+				{
+					sampleSum += samples[x + channel];
+				}
+				dataOut[y] = sampleSum * scale / channelCount * window[y];
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,229 @@
+#include "scene.h"
+#include "window.h"
+
+#include <algorithm>
+#include <iostream>
+
+// bar, line and area views together, the size of the area uniform arrays
+const int Scene::s_maxViews{ 8 };
+
+// curve segments between neighbouring band centers
+const int Scene::s_subdivisions{ 8 };
+
+// rows of history kept by every waterfall view
+const int Scene::s_historyRows{ 256 };
+
+// bandCount levels per source, sourceCount sources, maxLevel at the top of a view
+Scene::Scene(int bandCount, int sourceCount, GLfloat maxLevel)
+	: bandCount{ bandCount }, sourceCount{ sourceCount }, maxLevel{ maxLevel }, viewCounts{ 0, 0, 0 },
+	layoutChanged{ false }, drawCount{ 0 }, firstHeight{ 0 }
+{
+	// both programs read the shared levels, only the view areas change with the layout
+	barProgram.loadProgram("scene_bars.vert", "scene.frag");
+	curveProgram.loadProgram("scene_curve.vert", "scene.frag");
+	for (ShaderProgram* program : { &barProgram, &curveProgram })
+	{
+		program->use();
+		glUniform1i(glGetUniformLocation(program->getProgram(), "heights"), 0);
+		glUniform1i(glGetUniformLocation(program->getProgram(), "bandCount"), bandCount);
+		glUniform2f(glGetUniformLocation(program->getProgram(), "viewport"), static_cast<GLfloat>(Window::width), static_cast<GLfloat>(Window::height));
+		glUniform1f(glGetUniformLocation(program->getProgram(), "maxLevel"), maxLevel);
+	}
+	glUniform1i(glGetUniformLocation(curveProgram.getProgram(), "subdivisions"), s_subdivisions);
+	barFirstHeightLocation = glGetUniformLocation(barProgram.getProgram(), "firstHeight");
+	barFirstViewLocation = glGetUniformLocation(barProgram.getProgram(), "firstView");
+	curveFirstHeightLocation = glGetUniformLocation(curveProgram.getProgram(), "firstHeight");
+	curveFirstViewLocation = glGetUniformLocation(curveProgram.getProgram(), "firstView");
+	curveFilledLocation = glGetUniformLocation(curveProgram.getProgram(), "filled");
+	glUseProgram(0);
+
+	// core profile draws need a vertex array object, even an empty one
+	VAO = GLCreate::vertexArray();
+
+	// levels of every streamed view are fetched by index from one buffer texture
+	packed.reserve(static_cast<std::size_t>(s_maxViews) * bandCount);
+	heightBuffer.create(s_maxViews * bandCount * sizeof(GLfloat));
+	heightTexture = GLCreate::texture();
+	glBindTexture(GL_TEXTURE_BUFFER, heightTexture.get());
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, heightBuffer.getBuffer());
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+// adds a view of a source over an area of the window
+int Scene::addView(Kind kind, int source, const Rect &area)
+{
+	if (source < 0 || source >= sourceCount)
+	{
+		std::cerr << "Scene::addView(): source " << source << " out of range\n";
+		return -1;
+	}
+	if (kind != History && viewCounts[Bars] + viewCounts[Line] + viewCounts[Area] >= s_maxViews)
+	{
+		std::cerr << "Scene::addView(): at most " << s_maxViews << " bar, line and area views\n";
+		return -1;
+	}
+
+	View view{ kind, source, area, 0 };
+	if (kind == History)
+	{
+		view.slot = static_cast<int>(waterfalls.size());
+		waterfalls.emplace_back(new Waterfall(bandCount, s_historyRows, area.left, area.bottom, area.width, area.height));
+		waterfalls.back()->setScale(maxLevel);
+	}
+	else
+	{
+		++viewCounts[kind];
+		layoutChanged = true;
+	}
+	views.push_back(view);
+	return static_cast<int>(views.size()) - 1;
+}
+
+// remove every view
+void Scene::clear()
+{
+	views.clear();
+	waterfalls.clear();
+	viewCounts[Bars] = viewCounts[Line] = viewCounts[Area] = 0;
+	layoutChanged = true;
+}
+
+// assign streamed views their slots, grouped by kind, and upload their areas
+void Scene::layout()
+{
+	// bars first, then lines, then areas, so each kind is a contiguous run of slots
+	int nextSlot[3]{ 0, viewCounts[Bars], viewCounts[Bars] + viewCounts[Line] };
+	std::vector<GLfloat> areas(static_cast<std::size_t>(s_maxViews) * 4, 0.0f);
+	for (auto &view : views)
+	{
+		if (view.kind != History)
+		{
+			view.slot = nextSlot[view.kind]++;
+			areas[view.slot * 4] = view.area.left;
+			areas[view.slot * 4 + 1] = view.area.bottom;
+			areas[view.slot * 4 + 2] = view.area.width;
+			areas[view.slot * 4 + 3] = view.area.height;
+		}
+	}
+
+	for (ShaderProgram* program : { &barProgram, &curveProgram })
+	{
+		program->use();
+		glUniform4fv(glGetUniformLocation(program->getProgram(), "areas"), s_maxViews, areas.data());
+	}
+	glUseProgram(0);
+
+	const int streamedCount{ viewCounts[Bars] + viewCounts[Line] + viewCounts[Area] };
+	packed.resize(static_cast<std::size_t>(streamedCount) * bandCount);
+	layoutChanged = false;
+}
+
+// stream sourceCount * bandCount levels, source by source; addHistory adds them to waterfalls
+void Scene::update(const GLfloat* levels, bool addHistory)
+{
+	if (layoutChanged)
+	{
+		layout();
+	}
+
+	// gather the levels of every streamed view and write them with one map
+	for (const auto &view : views)
+	{
+		const GLfloat* source{ levels + static_cast<std::size_t>(view.source) * bandCount };
+		if (view.kind == History)
+		{
+			if (addHistory)
+			{
+				waterfalls[view.slot]->addRow(source);
+			}
+		}
+		else
+		{
+			std::copy(source, source + bandCount, packed.begin() + static_cast<std::size_t>(view.slot) * bandCount);
+		}
+	}
+
+	if (!packed.empty())
+	{
+		const GLintptr offset{ heightBuffer.write(packed.data(), packed.size() * sizeof(GLfloat)) };
+		if (offset >= 0)
+		{
+			firstHeight = static_cast<GLint>(offset / sizeof(GLfloat));
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+// draw every view, one draw per kind and per waterfall
+void Scene::draw()
+{
+	if (layoutChanged)
+	{
+		layout();
+	}
+	drawCount = 0;
+
+	const int streamedCount{ viewCounts[Bars] + viewCounts[Line] + viewCounts[Area] };
+	if (streamedCount > 0)
+	{
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_BUFFER, heightTexture.get());
+		glBindVertexArray(VAO.get());
+
+		if (viewCounts[Bars] > 0)
+		{
+			barProgram.use();
+			glUniform1i(barFirstHeightLocation, firstHeight);
+			glUniform1i(barFirstViewLocation, 0);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 6, viewCounts[Bars] * bandCount);
+			++drawCount;
+		}
+
+		// lines and areas are separate primitives built from whole segments,
+		// so views of one kind concatenate into a single draw
+		const int segmentsPerView{ (bandCount - 1) * s_subdivisions };
+		if (viewCounts[Line] + viewCounts[Area] > 0)
+		{
+			curveProgram.use();
+			glUniform1i(curveFirstHeightLocation, firstHeight);
+		}
+		if (viewCounts[Line] > 0)
+		{
+			glUniform1i(curveFirstViewLocation, viewCounts[Bars]);
+			glUniform1i(curveFilledLocation, GL_FALSE);
+			glDrawArrays(GL_LINES, 0, 2 * segmentsPerView * viewCounts[Line]);
+			++drawCount;
+		}
+		if (viewCounts[Area] > 0)
+		{
+			glUniform1i(curveFirstViewLocation, viewCounts[Bars] + viewCounts[Line]);
+			glUniform1i(curveFilledLocation, GL_TRUE);
+			glDrawArrays(GL_TRIANGLES, 0, 6 * segmentsPerView * viewCounts[Area]);
+			++drawCount;
+		}
+
+		glBindVertexArray(0);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+		// the levels segment may be rewritten once these draws complete
+		heightBuffer.fence();
+	}
+
+	for (const auto &waterfall : waterfalls)
+	{
+		waterfall->draw();
+		++drawCount;
+	}
+}
+
+// retrieve the amount of views
+int Scene::getViewCount() const
+{
+	return static_cast<int>(views.size());
+}
+
+// retrieve the amount of draws issued by the last draw()
+int Scene::getDrawCount() const
+{
+	return drawCount;
+}
@@ -0,0 +1,115 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glad/glad.h>
+#include <memory>
+#include <vector>
+#include "shader_program.h"
+#include "stream_buffer.h"
+#include "gl_handle.h"
+#include "waterfall.h"
+
+/*
+	Several visualizations side by side in one window. Every view covers
+	an area of the window and shows one source, an array of band levels
+	such as the mixed signal or a single channel.
+
+	Views are batched by kind rather than drawn one by one: the levels of
+	all bar, line and area views are streamed into one shared buffer with
+	a single write per frame, and each kind is one draw whose vertex
+	shader finds its view from the instance or vertex index and reads the
+	view's area from a uniform array. Waterfalls keep their own history
+	texture and draw once each. Adding a view therefore adds at most one
+	draw, and none when a view of its kind exists already.
+*/
+class Scene
+{
+public:
+	// what a view shows
+	enum Kind
+	{
+		Bars,			// one bar per band
+		Line,			// Catmull-Rom line through the band levels
+		Area,			// the same curve filled down to the bottom of the view
+		History			// scrolling waterfall of past levels
+	};
+
+	// window area in pixels
+	struct Rect
+	{
+		GLfloat left;
+		GLfloat bottom;
+		GLfloat width;
+		GLfloat height;
+	};
+
+	/*
+		bandCount - levels per source
+		sourceCount - amount of sources passed to update()
+		maxLevel - level shown at the top of a view
+	*/
+	Scene(int bandCount, int sourceCount, GLfloat maxLevel);
+
+	/*
+		Adds a view of a source over an area of the window. Bar, line and
+		area views together are limited to s_maxViews.
+
+		Returns the view id on success and -1 on failure.
+	*/
+	int addView(Kind kind, int source, const Rect &area);
+
+	void clear();									// remove every view
+
+	// stream sourceCount * bandCount levels, source by source; addHistory adds them to waterfalls
+	void update(const GLfloat* levels, bool addHistory);
+	void draw();									// draw every view, one draw per kind and per waterfall
+
+	int getViewCount() const;						// retrieve the amount of views
+	int getDrawCount() const;						// retrieve the amount of draws issued by the last draw()
+
+	static const int s_maxViews;
+
+private:
+	static const int s_subdivisions;
+	static const int s_historyRows;
+
+	struct View
+	{
+		Kind kind;
+		int source;
+		Rect area;
+		int slot;		// position among the streamed views, or index of the waterfall
+	};
+
+	// assign streamed views their slots, grouped by kind, and upload their areas
+	void layout();
+
+	const int bandCount;
+	const int sourceCount;
+	const GLfloat maxLevel;
+
+	std::vector<View> views;
+	int viewCounts[3];			// amount of bar, line and area views
+	bool layoutChanged;
+	int drawCount;
+
+	std::vector<std::unique_ptr<Waterfall>> waterfalls;
+	std::vector<GLfloat> packed;	// levels of the streamed views in slot order
+
+	ShaderProgram barProgram;
+	ShaderProgram curveProgram;
+	GLint barFirstHeightLocation;
+	GLint barFirstViewLocation;
+	GLint curveFirstHeightLocation;
+	GLint curveFirstViewLocation;
+	GLint curveFilledLocation;
+
+	// first level of the latest frame within the level buffer
+	GLint firstHeight;
+
+	GLVertexArray VAO;
+	GLTexture heightTexture;
+	StreamBuffer heightBuffer;
+};
+
+#endif
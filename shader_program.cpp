@@ -1,91 +1,164 @@
 #include "shader_program.h"
+#include "shader_sources.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <fstream>
-#include <string>
+#include <iterator>
+#include <vector>
 
-// default constructor
-ShaderProgram::ShaderProgram()
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// shader files placed here replace the embedded sources
+std::string ShaderProgram::s_overrideDirectory{ "shaders" };
+
+// program binaries are kept here
+std::string ShaderProgram::s_cacheDirectory{ "shader_cache" };
+
+namespace
 {
+	// identifies cache files and their layout
+	const char s_binaryMagic[4]{ 'A', 'S', 'P', 'B' };
+
+	// 64 bit FNV-1a hash of a string, continuing from hash
+	std::uint64_t hashString(const std::string &text, std::uint64_t hash = 14695981039346656037ULL)
+	{
+		for (unsigned char c : text)
+		{
+			hash = (hash ^ c) * 1099511628211ULL;
+		}
+		// hash a separator too, so consecutive strings cannot shift into each other
+		return (hash ^ 0xFF) * 1099511628211ULL;
+	}
+
+	// retrieve a GL string, empty when the driver returns none
+	std::string getGLString(GLenum name)
+	{
+		const GLubyte* value{ glGetString(name) };
+		return value ? reinterpret_cast<const char*>(value) : "";
+	}
 }
 
-// destructor, deallocate OpenGL program resources
-ShaderProgram::~ShaderProgram()
+// default constructor
+ShaderProgram::ShaderProgram() : cached{ false }
 {
-	glDeleteProgram(program);
 }
 
-// compiles and links a program from specified shader files
-void ShaderProgram::loadProgram(const GLchar* vertexPath, const GLchar* fragmentPath, const GLchar* geometryPath)
+// compiles and links a program from named shaders, or loads it from the binary cache
+void ShaderProgram::loadProgram(const GLchar* vertexName, const GLchar* fragmentName, const GLchar* geometryName)
 {
-	// compile shaders from file paths
-	GLuint vertexShader{ loadShaderFile(GL_VERTEX_SHADER, vertexPath) };
-	GLuint fragmentShader{ loadShaderFile(GL_FRAGMENT_SHADER, fragmentPath) };
-	GLuint geometryShader{ geometryPath ? loadShaderFile(GL_GEOMETRY_SHADER, geometryPath) : 0 };
+	const std::string vertexSource{ loadSource(vertexName) };
+	const std::string fragmentSource{ loadSource(fragmentName) };
+	const std::string geometrySource{ geometryName ? loadSource(geometryName) : std::string() };
 
-	// create a program and attach shaders
-	program = glCreateProgram();
-	glAttachShader(program, vertexShader);
-	glAttachShader(program, fragmentShader);
-	if (geometryPath)
+	// create a program, replacing any previous program
+	program.reset(glCreateProgram());
+	const GLuint id{ program.get() };
+	const std::string cachePath{ getCachePath(vertexSource, fragmentSource, geometrySource) };
+	cached = !cachePath.empty() && loadBinary(cachePath);
+	if (cached)
 	{
-		glAttachShader(program, geometryShader);
+		return;
+	}
+
+	// compile shaders and attach them
+	GLShader vertexShader{ createShader(GL_VERTEX_SHADER, vertexSource.c_str()) };
+	GLShader fragmentShader{ createShader(GL_FRAGMENT_SHADER, fragmentSource.c_str()) };
+	GLShader geometryShader{ geometryName ? createShader(GL_GEOMETRY_SHADER, geometrySource.c_str()) : GLShader() };
+	glAttachShader(id, vertexShader.get());
+	glAttachShader(id, fragmentShader.get());
+	if (geometryName)
+	{
+		glAttachShader(id, geometryShader.get());
 	}
 
 	// query for link status
-	glLinkProgram(program);
+	if (!cachePath.empty())
+	{
+		glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glLinkProgram(id);
 	GLint linkStatus;
-	glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+	glGetProgramiv(id, GL_LINK_STATUS, &linkStatus);
 	if (!linkStatus)
 	{
 		// retrieve info log information
 		GLint infoLogLength;
-		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLogLength);
-		GLchar* infoLog{ new GLchar[infoLogLength + 1] };
-		glGetProgramInfoLog(program, infoLogLength, nullptr, infoLog);
+		glGetProgramiv(id, GL_INFO_LOG_LENGTH, &infoLogLength);
+		std::vector<GLchar> infoLog(infoLogLength + 1);
+		glGetProgramInfoLog(id, infoLogLength, nullptr, infoLog.data());
 
 		// print error message
-		std::cerr << "Failed to link shader program: " << infoLog;
-		delete[] infoLog;
+		std::cerr << "Failed to link shader program: " << infoLog.data();
+	}
+	else if (!cachePath.empty())
+	{
+		saveBinary(cachePath);
 	}
 
-	// detach and delete shaders
-	glDetachShader(program, vertexShader);
-	glDetachShader(program, fragmentShader);
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	if (geometryPath)
+	// detach shaders, their handles delete them
+	glDetachShader(id, vertexShader.get());
+	glDetachShader(id, fragmentShader.get());
+	if (geometryName)
 	{
-		glDetachShader(program, geometryShader);
-		glDeleteShader(geometryShader);
+		glDetachShader(id, geometryShader.get());
 	}
 }
 
 // use program
 void ShaderProgram::use()
 {
-	glUseProgram(program);
+	glUseProgram(program.get());
+}
+
+// retrieve OpenGL program ID
+GLuint ShaderProgram::getProgram() const
+{
+	return program.get();
+}
+
+// retrieve whether the last load came from the binary cache
+bool ShaderProgram::isCached() const
+{
+	return cached;
+}
+
+// set where shader files replace embedded sources
+void ShaderProgram::setOverrideDirectory(const std::string &directory)
+{
+	s_overrideDirectory = directory;
+}
+
+// set where program binaries are kept, empty disables the cache
+void ShaderProgram::setCacheDirectory(const std::string &directory)
+{
+	s_cacheDirectory = directory;
 }
 
 // creates a shader from C-style string source
-GLuint ShaderProgram::createShader(GLenum shaderType, const GLchar* shaderSource)
+GLShader ShaderProgram::createShader(GLenum shaderType, const GLchar* shaderSource)
 {
 	// create and compile shader
-	GLuint shader{ glCreateShader(shaderType) };
-	glShaderSource(shader, 1, &shaderSource, nullptr);
-	glCompileShader(shader);
+	GLShader shader{ glCreateShader(shaderType) };
+	glShaderSource(shader.get(), 1, &shaderSource, nullptr);
+	glCompileShader(shader.get());
 
 	// query for compile status
 	GLint compileStatus;
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+	glGetShaderiv(shader.get(), GL_COMPILE_STATUS, &compileStatus);
 	if (!compileStatus)
 	{
 		// retrieve info log information
 		GLint infoLogLength;
-		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
-		GLchar* infoLog{ new GLchar[infoLogLength + 1] };
-		glGetShaderInfoLog(shader, infoLogLength, nullptr, infoLog);
+		glGetShaderiv(shader.get(), GL_INFO_LOG_LENGTH, &infoLogLength);
+		std::vector<GLchar> infoLog(infoLogLength + 1);
+		glGetShaderInfoLog(shader.get(), infoLogLength, nullptr, infoLog.data());
 
 		// print error message
 		const char* strShaderType{ nullptr };
@@ -105,22 +178,128 @@ GLuint ShaderProgram::createShader(GLenum shaderType, const GLchar* shaderSource
 			break;
 		}
 
-		std::cerr << "Failed to compile " << strShaderType << " shader: " << infoLog;
-		delete[] infoLog;
+		std::cerr << "Failed to compile " << strShaderType << " shader: " << infoLog.data();
 	}
 
 	return shader;
 }
 
-// returns a shader created from a file path
-GLuint ShaderProgram::loadShaderFile(GLenum shaderType, const char* path)
+// returns the source of a named shader
+std::string ShaderProgram::loadSource(const char* name)
+{
+	if (!s_overrideDirectory.empty())
+	{
+		std::ifstream shaderFile(s_overrideDirectory + "/" + name);
+		if (shaderFile)
+		{
+			std::stringstream shaderStream;
+			shaderStream << shaderFile.rdbuf();
+			return shaderStream.str();
+		}
+	}
+
+	for (const auto &embedded : ShaderSources::s_embedded)
+	{
+		if (std::strcmp(embedded.name, name) == 0)
+		{
+			return embedded.source;
+		}
+	}
+
+	std::cerr << "ShaderProgram::loadSource(): no shader named " << name << '\n';
+	return std::string();
+}
+
+// retrieve the cache file of a program, empty when binaries are unsupported or disabled
+std::string ShaderProgram::getCachePath(const std::string &vertexSource, const std::string &fragmentSource, const std::string &geometrySource)
+{
+	// program binaries are core in 4.1, a 3.3 request usually gets a newer context
+	if (s_cacheDirectory.empty() || !GLAD_GL_VERSION_4_1)
+	{
+		return std::string();
+	}
+	GLint formatCount{ 0 };
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	if (formatCount < 1)
+	{
+		return std::string();
+	}
+
+	// a binary is only valid for the driver that produced it
+	std::uint64_t hash{ hashString(getGLString(GL_VENDOR)) };
+	hash = hashString(getGLString(GL_RENDERER), hash);
+	hash = hashString(getGLString(GL_VERSION), hash);
+	hash = hashString(vertexSource, hash);
+	hash = hashString(fragmentSource, hash);
+	hash = hashString(geometrySource, hash);
+
+	std::ostringstream path;
+	path << s_cacheDirectory << '/' << std::hex;
+	path.width(16);
+	path.fill('0');
+	path << hash << ".bin";
+	return path.str();
+}
+
+// link program from a cached binary
+bool ShaderProgram::loadBinary(const std::string &path)
+{
+	std::ifstream file(path, std::ios::binary);
+	char magic[sizeof(s_binaryMagic)];
+	std::uint32_t format;
+	if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, s_binaryMagic, sizeof(magic)) != 0 ||
+		!file.read(reinterpret_cast<char*>(&format), sizeof(format)))
+	{
+		return false;
+	}
+	const std::vector<char> binary{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	if (binary.empty())
+	{
+		return false;
+	}
+
+	// a format the driver does not list is an error rather than a failed link
+	GLint formatCount{ 0 };
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	std::vector<GLint> formats(formatCount);
+	glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+	if (std::find(formats.begin(), formats.end(), static_cast<GLint>(format)) == formats.end())
+	{
+		return false;
+	}
+
+	// drivers reject binaries of other builds through the link status
+	glProgramBinary(program.get(), format, binary.data(), static_cast<GLsizei>(binary.size()));
+	GLint linkStatus;
+	glGetProgramiv(program.get(), GL_LINK_STATUS, &linkStatus);
+	return linkStatus == GL_TRUE;
+}
+
+// write the linked program to the cache
+void ShaderProgram::saveBinary(const std::string &path)
 {
-	std::ifstream shaderFile(path);
-	std::stringstream shaderStream;
-	shaderStream << shaderFile.rdbuf();
-	shaderFile.close();
-
-	std::string shaderString(shaderStream.str());
-	const GLchar* shaderSource{ shaderString.c_str() };
-	return createShader(shaderType, shaderSource);
+	GLint length{ 0 };
+	glGetProgramiv(program.get(), GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length < 1)
+	{
+		return;
+	}
+	std::vector<char> binary(length);
+	GLenum format;
+	glGetProgramBinary(program.get(), length, nullptr, &format, binary.data());
+
+	// the directory usually exists already, a real failure shows up when opening the file
+#ifdef _WIN32
+	_mkdir(s_cacheDirectory.c_str());
+#else
+	mkdir(s_cacheDirectory.c_str(), 0755);
+#endif
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	const std::uint32_t storedFormat{ format };
+	if (!file.write(s_binaryMagic, sizeof(s_binaryMagic)) ||
+		!file.write(reinterpret_cast<const char*>(&storedFormat), sizeof(storedFormat)) ||
+		!file.write(binary.data(), binary.size()))
+	{
+		std::cerr << "ShaderProgram::saveBinary(): could not write " << path << '\n';
+	}
 }
\ No newline at end of file
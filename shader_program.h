@@ -2,28 +2,56 @@
 #define SHADER_H
 
 #include <glad/glad.h>
-
+#include <string>
+#include "gl_handle.h"
+
+/*
+	Owns its OpenGL program, so it can be moved but not copied.
+
+	Shader sources are looked up by file name: a file in the override
+	directory wins, otherwise the source embedded in shader_sources.h is
+	used. Linked programs are saved with glGetProgramBinary in the cache
+	directory, under a hash of the driver's vendor, renderer and version
+	strings and of every source, and later loads of the same program
+	skip compilation. A binary the driver rejects is rebuilt from source.
+*/
 class ShaderProgram
 {
 public:
 	// default constructor
 	ShaderProgram();
 
-	// destructor
-	~ShaderProgram();
-
-	// compiles and links program from specified shader files
-	void loadProgram(const GLchar* vertexPath, const GLchar* fragmentPath, const GLchar* geometryPath = nullptr);
+	// compiles and links program from named shaders, or loads it from the binary cache
+	void loadProgram(const GLchar* vertexName, const GLchar* fragmentName, const GLchar* geometryName = nullptr);
 
 	// use program
 	void use();
 
-	// OpenGL program ID
-	GLuint program;
+	// retrieve OpenGL program ID
+	GLuint getProgram() const;
+
+	// retrieve whether the last load came from the binary cache
+	bool isCached() const;
+
+	static void setOverrideDirectory(const std::string &directory);	// set where shader files replace embedded sources
+	static void setCacheDirectory(const std::string &directory);	// set where program binaries are kept, empty disables the cache
 
 private:
-	GLuint createShader(GLenum shaderType, const GLchar* shaderSource);		// creates a shader from C-style string source
-	GLuint loadShaderFile(GLenum shaderType, const char* path);				// returns a shader created from a file path
+	static std::string s_overrideDirectory;
+	static std::string s_cacheDirectory;
+
+	GLShader createShader(GLenum shaderType, const GLchar* shaderSource);	// creates a shader from C-style string source
+	std::string loadSource(const char* name);								// returns the source of a named shader
+
+	// retrieve the cache file of a program, empty when binaries are unsupported or disabled
+	static std::string getCachePath(const std::string &vertexSource, const std::string &fragmentSource, const std::string &geometrySource);
+
+	bool loadBinary(const std::string &path);	// link program from a cached binary
+	void saveBinary(const std::string &path);	// write the linked program to the cache
+
+	// OpenGL program
+	GLProgram program;
+	bool cached;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,267 @@
+#ifndef SHADER_SOURCES_H
+#define SHADER_SOURCES_H
+
+/*
+	GLSL sources compiled into the executable, so the program starts
+	without reading any files. A file of the same name in the override
+	directory of ShaderProgram replaces the embedded source, which allows
+	editing shaders without rebuilding.
+*/
+namespace ShaderSources
+{
+	// bars.vert: bar quads built from gl_VertexID, heights pulled from a buffer texture
+	constexpr const char* barsVertex{ R"glsl(#version 330
+
+uniform samplerBuffer heights;	// height of every bar in pixels
+uniform int firstBar;			// index of the first bar's height in heights
+
+uniform vec2 viewport;		// window size in pixels
+uniform float baseline;		// bottom edge of the bars in pixels
+uniform float left;			// left edge of the first bar in pixels
+uniform float step;			// distance between the left edges of neighbouring bars
+uniform float barWidth;		// width of a bar in pixels
+
+// two triangles of a unit quad, indexed by gl_VertexID
+const vec2 corners[6] = vec2[6](
+	vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 0.0),
+	vec2(1.0, 1.0), vec2(1.0, 0.0), vec2(0.0, 1.0)
+);
+
+void main()
+{
+	vec2 corner = corners[gl_VertexID];
+	float height = texelFetch(heights, firstBar + gl_InstanceID).r;
+	vec2 pixel = vec2(left + gl_InstanceID * step + corner.x * barWidth, baseline + corner.y * height);
+	gl_Position = vec4(pixel / viewport * 2.0 - 1.0, 0.0, 1.0);
+})glsl" };
+
+	// curve.vert: line or filled strip through the bar centers, Catmull-Rom between them
+	constexpr const char* curveVertex{ R"glsl(#version 330
+
+uniform samplerBuffer heights;	// height of every bar in pixels
+uniform int firstBar;			// index of the first bar's height in heights
+uniform int barCount;			// amount of heights in the frame
+
+uniform vec2 viewport;		// window size in pixels
+uniform float baseline;		// bottom edge of the curve in pixels
+uniform float left;			// left edge of the first bar in pixels
+uniform float step;			// distance between the left edges of neighbouring bars
+uniform float barWidth;		// width of a bar in pixels
+
+uniform int subdivisions;	// points per bar, 1 connects the bar tops directly
+uniform bool filled;		// triangle strip down to the baseline instead of a line strip
+
+float heightAt(int bar)
+{
+	return texelFetch(heights, firstBar + clamp(bar, 0, barCount - 1)).r;
+}
+
+void main()
+{
+	// a filled strip alternates between the baseline and the curve
+	int point = filled ? gl_VertexID / 2 : gl_VertexID;
+	bool onCurve = !filled || (gl_VertexID & 1) == 1;
+
+	// uniform Catmull-Rom spline through the bar tops
+	int bar = point / subdivisions;
+	float t = float(point - bar * subdivisions) / float(subdivisions);
+	float p0 = heightAt(bar - 1);
+	float p1 = heightAt(bar);
+	float p2 = heightAt(bar + 1);
+	float p3 = heightAt(bar + 2);
+	float height = 0.5 * (2.0 * p1 + (p2 - p0) * t
+		+ (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3) * t * t
+		+ (3.0 * (p1 - p2) + p3 - p0) * t * t * t);
+
+	// the spline overshoots around sharp peaks, never dip below the baseline
+	height = onCurve ? max(height, 0.0) : 0.0;
+	float x = left + (float(bar) + t) * step + 0.5 * barWidth;
+	gl_Position = vec4(vec2(x, baseline + height) / viewport * 2.0 - 1.0, 0.0, 1.0);
+})glsl" };
+
+	// basic.frag: vertical gradient of the spectrum
+	constexpr const char* basicFragment{ R"glsl(#version 330
+
+out vec4 fragColor;
+
+void main()
+{
+	float lerp = (gl_FragCoord.y - 100.0f) / 600.0f;
+	fragColor = vec4(lerp, 1.0f - lerp, 1.0f - lerp, 1.0f);
+})glsl" };
+
+	// waterfall.vert: quad covering the waterfall area
+	constexpr const char* waterfallVertex{ R"glsl(#version 330
+
+uniform vec2 viewport;	// window size in pixels
+uniform vec4 bounds;	// left, bottom, width and height of the view in pixels
+
+out vec2 texCoord;
+
+// triangle strip of a unit quad, indexed by gl_VertexID
+const vec2 corners[4] = vec2[4](
+	vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0)
+);
+
+void main()
+{
+	texCoord = corners[gl_VertexID];
+	vec2 pixel = bounds.xy + texCoord * bounds.zw;
+	gl_Position = vec4(pixel / viewport * 2.0 - 1.0, 0.0, 1.0);
+})glsl" };
+
+	// waterfall.frag: ring texture lookup through the colormap
+	constexpr const char* waterfallFragment{ R"glsl(#version 330
+
+uniform sampler2D history;		// one row of levels per analysis frame, used as a ring
+uniform sampler1D colormap;
+uniform float newestRow;		// ring row holding the latest levels
+uniform float rowCount;
+uniform float colormapSize;
+uniform float scale;			// converts levels to [0, 1]
+
+in vec2 texCoord;
+out vec4 fragColor;
+
+void main()
+{
+	// the newest row is at the top and older rows scroll down, rows
+	// before the start of the ring wrap around to its end. Texel n covers
+	// [n, n + 1), so the view spans (newestRow + 1 - rowCount, newestRow + 1]
+	// and shows exactly the oldest through the newest row
+	float row = newestRow + 1.0 - (1.0 - texCoord.y) * rowCount;
+	float level = texture(history, vec2(texCoord.x, row / rowCount)).r;
+
+	// sample between the centers of the first and last colormap entries
+	float position = clamp(level * scale, 0.0, 1.0);
+	fragColor = vec4(texture(colormap, (0.5 + position * (colormapSize - 1.0)) / colormapSize).rgb, 1.0);
+})glsl" };
+
+	// scene_bars.vert: bars of every bar view in one instanced draw
+	constexpr const char* sceneBarsVertex{ R"glsl(#version 330
+
+uniform samplerBuffer heights;	// heights of every spectrum view, bandCount per view
+uniform int firstHeight;		// index of the frame's first height in heights
+uniform int firstView;			// view of the first instance of this draw
+uniform int bandCount;			// heights per view
+
+uniform vec2 viewport;			// window size in pixels
+uniform float maxLevel;			// level filling a view's full height
+uniform vec4 areas[8];			// left, bottom, width and height of every view in pixels
+
+out float level;
+
+// two triangles of a unit quad, indexed by gl_VertexID
+const vec2 corners[6] = vec2[6](
+	vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 0.0),
+	vec2(1.0, 1.0), vec2(1.0, 0.0), vec2(0.0, 1.0)
+);
+
+void main()
+{
+	int view = firstView + gl_InstanceID / bandCount;
+	int bar = gl_InstanceID - (view - firstView) * bandCount;
+	vec4 area = areas[view];
+
+	// bars share the view's width, one pixel apart where there is room
+	float step = area.z / float(bandCount);
+	float barWidth = max(step - 1.0, min(step, 1.0));
+
+	vec2 corner = corners[gl_VertexID];
+	float value = min(texelFetch(heights, firstHeight + view * bandCount + bar).r / maxLevel, 1.0);
+	level = corner.y * value;
+	vec2 pixel = vec2(area.x + float(bar) * step + corner.x * barWidth, area.y + level * area.w);
+	gl_Position = vec4(pixel / viewport * 2.0 - 1.0, 0.0, 1.0);
+})glsl" };
+
+	// scene_curve.vert: lines or filled areas of every curve view of one kind in one draw
+	constexpr const char* sceneCurveVertex{ R"glsl(#version 330
+
+uniform samplerBuffer heights;	// heights of every spectrum view, bandCount per view
+uniform int firstHeight;		// index of the frame's first height in heights
+uniform int firstView;			// view of the first segment of this draw
+uniform int bandCount;			// heights per view
+
+uniform vec2 viewport;			// window size in pixels
+uniform float maxLevel;			// level filling a view's full height
+uniform vec4 areas[8];			// left, bottom, width and height of every view in pixels
+
+uniform int subdivisions;		// segments between neighbouring bar centers
+uniform bool filled;			// two triangles per segment down to the bottom instead of a line
+
+out float level;
+
+// segment end (x) and whether the vertex lies on the curve (y), indexed by
+// gl_VertexID within a segment: 6 vertices when filled, 2 for lines
+const vec2 fillCorners[6] = vec2[6](
+	vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 0.0),
+	vec2(1.0, 1.0), vec2(1.0, 0.0), vec2(0.0, 1.0)
+);
+
+float heightAt(int view, int bar)
+{
+	return texelFetch(heights, firstHeight + view * bandCount + clamp(bar, 0, bandCount - 1)).r;
+}
+
+void main()
+{
+	int verticesPerSegment = filled ? 6 : 2;
+	int segment = gl_VertexID / verticesPerSegment;
+	int vertex = gl_VertexID - segment * verticesPerSegment;
+	vec2 corner = filled ? fillCorners[vertex] : vec2(float(vertex), 1.0);
+
+	int segmentsPerView = (bandCount - 1) * subdivisions;
+	int view = firstView + segment / segmentsPerView;
+	int point = segment - (view - firstView) * segmentsPerView + int(corner.x);
+	vec4 area = areas[view];
+
+	// uniform Catmull-Rom spline through the bar tops
+	int bar = point / subdivisions;
+	float t = float(point - bar * subdivisions) / float(subdivisions);
+	float p0 = heightAt(view, bar - 1);
+	float p1 = heightAt(view, bar);
+	float p2 = heightAt(view, bar + 1);
+	float p3 = heightAt(view, bar + 2);
+	float height = 0.5 * (2.0 * p1 + (p2 - p0) * t
+		+ (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3) * t * t
+		+ (3.0 * (p1 - p2) + p3 - p0) * t * t * t);
+
+	// the spline overshoots around sharp peaks, keep it inside the view
+	level = corner.y * clamp(height / maxLevel, 0.0, 1.0);
+	float step = area.z / float(bandCount);
+	float x = area.x + (float(bar) + t + 0.5) * step;
+	gl_Position = vec4(vec2(x, area.y + level * area.w) / viewport * 2.0 - 1.0, 0.0, 1.0);
+})glsl" };
+
+	// scene.frag: vertical gradient over the height of a view
+	constexpr const char* sceneFragment{ R"glsl(#version 330
+
+in float level;		// height within the view, 0 at the bottom and 1 at the top
+
+out vec4 fragColor;
+
+void main()
+{
+	fragColor = vec4(level, 1.0f - level, 1.0f - level, 1.0f);
+})glsl" };
+
+	struct Embedded
+	{
+		const char* name;
+		const char* source;
+	};
+
+	// every embedded source by file name
+	constexpr Embedded s_embedded[]{
+		{ "bars.vert", barsVertex },
+		{ "curve.vert", curveVertex },
+		{ "basic.frag", basicFragment },
+		{ "waterfall.vert", waterfallVertex },
+		{ "waterfall.frag", waterfallFragment },
+		{ "scene_bars.vert", sceneBarsVertex },
+		{ "scene_curve.vert", sceneCurveVertex },
+		{ "scene.frag", sceneFragment }
+	};
+}
+
+#endif
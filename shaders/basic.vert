@@ -1,8 +0,0 @@
-#version 330
-
-layout (location = 0) in vec2 pos;
-
-void main()
-{
-	gl_Position = vec4(pos.xy, 0.0, 1.0);
-}
\ No newline at end of file
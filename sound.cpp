@@ -4,137 +4,511 @@
 
 #include <iostream>
 #include <cmath>
+#include <cctype>
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include "fft.h"
+#include "sample_kernel.h"
+
+namespace
+{
+	// returns true if a path ends with the given lowercase extension
+	bool hasExtension(const std::string &path, const std::string &extension)
+	{
+		if (path.size() < extension.size())
+		{
+			return false;
+		}
+		for (std::size_t x{ 0 }; x < extension.size(); ++x)
+		{
+			const char c{ path[path.size() - extension.size() + x] };
+			if (std::tolower(static_cast<unsigned char>(c)) != extension[x])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+// seconds of compressed audio decoded before playback can start
+const float Sound::s_initialDecodeSeconds{ 3.0f };
+
+// analyzedPos before any successful analysis
+const std::size_t Sound::s_notAnalyzed{ static_cast<std::size_t>(-1) };
+
+// FFT sizes with a prebuilt plan
+const int Sound::s_minFftSize{ 1024 };
+const int Sound::s_maxFftSize{ 16384 };
+
+// amount of octaves analyzed at successively halved sample rates
+const int Sound::s_multirateLevels{ 4 };
+
+// plain magnitudes, as stored in the spectrogram cache
+const SpectrumKernel::Params Sound::s_rawMagnitudes{ SpectrumKernel::Magnitude, 1.0f, 0.0f, std::numeric_limits<float>::max() };
 
 Sound::Sound(const std::string &soundPath, int fftSize)
+	: soundPath{ soundPath }, plan{ nullptr }, cachePlan{ nullptr }, multirate{ nullptr }, cacheReady{ false }, cacheCancelled{ false }, int16Samples{ nullptr }, floatSamples{ nullptr }
 {
-	// attempt to load sound buffer from audio file
-	if (!soundBuffer.loadFromFile(soundPath))
+	// uncompressed files are mapped and read in place, headerless
+	// raw files are assumed to be 16-bit stereo at 44.1 kHz
+	if ((hasExtension(soundPath, ".wav") && pcm.openWav(soundPath)) ||
+		(hasExtension(soundPath, ".raw") && pcm.openRaw(soundPath, MappedPcm::Int16, 2, 44100)))
+	{
+		int16Samples = pcm.getInt16Samples();
+		floatSamples = pcm.getFloatSamples();
+		sampleRate = pcm.getSampleRate();
+		sampleCount = pcm.getSampleCount();
+		channelCount = pcm.getChannelCount();
+	}
+	// anything else starts playing after the first seconds are decoded,
+	// the rest is decoded on all hardware threads in the background
+	else if (decoder.open(soundPath, s_initialDecodeSeconds))
+	{
+		int16Samples = decoder.getSamples();
+		sampleRate = static_cast<int>(decoder.getSampleRate());
+		sampleCount = decoder.getSampleCount();
+		channelCount = static_cast<int>(decoder.getChannelCount());
+	}
+	else
+	{
+		std::cerr << "Sound::Sound(): unable to decode sound file\n";
+		sampleRate = 0;
+		sampleCount = 0;
+		channelCount = 0;
+	}
+
+	if (channelCount > 0)
 	{
-		std::cerr << "Sound::Sound(): unable to load sound buffer\n";
+		if (floatSamples)
+		{
+			stream.setSamples(floatSamples, sampleCount, channelCount, sampleRate);
+		}
+		else
+		{
+			stream.setSamples(int16Samples, sampleCount, channelCount, sampleRate);
+			if (!decoder.isComplete())
+			{
+				stream.setReadyCounter(decoder.getReadyCounter(), decoder.getCompleteFlag());
+			}
+		}
 	}
-	sound.setBuffer(soundBuffer);
-	sound.setLoop(true);
+	stream.setLoop(true);
 
 	// initialize member variables
-	sampleRate = static_cast<int>(soundBuffer.getSampleRate());
-	sampleCount = static_cast<int>(soundBuffer.getSampleCount());
-	channelCount = static_cast<int>(soundBuffer.getChannelCount());
 	samplePos = 0;
-	this->fftSize = fftSize;
-	freqRes = static_cast<double>(sampleRate) / fftSize;
+	analyzedPos = s_notAnalyzed;
 
-	// initialize hann window
-	for (int x{ 0 }; x < fftSize; ++x)
+	// the transform only takes powers of 2, other sizes are rounded up
+	if (fftSize < 2 || (fftSize & (fftSize - 1)))
 	{
-		double y = sin((M_PI * x) / (fftSize - 1));
-		hannWindow.push_back(y * y);
+		int rounded{ 2 };
+		while (rounded < fftSize)
+		{
+			rounded *= 2;
+		}
+		std::cerr << "Sound::Sound(): FFT size " << fftSize << " is not a power of 2, using " << rounded << '\n';
+		fftSize = rounded;
 	}
 
-	// initialize bin frequencies with freq resolution
-	for (int x{ 0 }; x < fftSize; ++x)
+	// initialize hann windows of every power of 2 size from the smallest pooled
+	// one (or a smaller size asked for) up to the largest one (or a larger size asked for)
+	const int largest{ std::max(fftSize, s_maxFftSize) };
+	for (int size{ std::min(fftSize, s_minFftSize) }; size <= largest; size *= 2)
 	{
-		binFreq.push_back(x * freqRes);
+		AnalysisPlan sizePlan;
+		sizePlan.fftSize = size;
+		for (int x{ 0 }; x < size; ++x)
+		{
+			double y = sin((M_PI * x) / (size - 1));
+			sizePlan.window.push_back(y * y);
+		}
+		plans.push_back(std::move(sizePlan));
 	}
+	multirateAnalyzers.resize(plans.size());
 
-	fftBins.resize(fftSize);
+	// buffers hold the largest size, so switching sizes only changes their length
+	fftBins.reserve(largest);
+	channelBins.reserve(largest);
+	binFreq.reserve(largest);
+	magnitudes.reserve(largest / 2);
+	this->fftSize = 0;
+	if (!setFftSize(fftSize))
+	{
+		setFftSize(plans.back().fftSize);
+	}
+}
+
+// destructor, stops building the spectrogram cache
+Sound::~Sound()
+{
+	cacheCancelled = true;
+	if (cacheBuilder.joinable())
+	{
+		cacheBuilder.join();
+	}
+	stream.cancelWait();
+	stream.stop();
 }
 
-void Sound::update()
+bool Sound::update()
 {
-	// check for stereo input
-	if (channelCount == 2)
+	// the device offset only moves once per buffer, the clock fills in between
+	const double position{ clock.update(stream.getPlayingOffset().asSeconds(), stream.getStatus() == sf::SoundStream::Playing) };
+	return update(static_cast<std::size_t>(position * sampleRate));
+}
+
+// update frequency bins at a sample frame instead of the playing position,
+// returns true if the bins changed
+bool Sound::update(std::size_t framePos)
+{
+	samplePos = framePos;
+
+	// map the cache once the background thread found or wrote it
+	if (cacheReady.exchange(false))
 	{
-		// retrieve current sample data and apply hann window
-		samplePos = static_cast<int>((sound.getPlayingOffset().asSeconds()) * (sampleRate * 2));
-		if ((samplePos + fftSize * 2) >= sampleCount)
+		cacheBuilder.join();
+		cache.open(cachePath, cacheHeader);
+		analyzedPos = s_notAnalyzed;
+	}
+
+	// the bins of this position are already there, e.g. while paused
+	if (samplePos == analyzedPos)
+	{
+		return false;
+	}
+
+	bool analyzed{ true };
+	if (multirate)
+	{
+		analyzed = analyzeMultirate(samplePos);
+	}
+	else if (isCached())
+	{
+		// read the nearest precomputed frame, no FFT work needed
+		const int hopSize{ cache.getHopSize() };
+		currentMagnitudes = cache.getFrame(static_cast<int>((samplePos + hopSize / 2) / hopSize));
+	}
+	else if (analyze(samplePos, *plan, fftBins))
+	{
+		// levels are converted straight from the transformed bins
+		currentMagnitudes = nullptr;
+	}
+	else
+	{
+		analyzed = false;
+	}
+
+	// a window past the decoded samples is retried on the next update. One
+	// that can never be read (the end of the file, or no samples at all)
+	// keeps the previous bins and counts as analyzed, so it is not pending
+	analyzedPos = analyzed || !isDecoding() ? samplePos : s_notAnalyzed;
+	return analyzed;
+}
+
+// retrieve whether the position waits for its samples to be decoded
+bool Sound::isAnalysisPending()
+{
+	return analyzedPos != samplePos;
+}
+
+// retrieve whether update() reads the current FFT size from the cache
+bool Sound::isCached()
+{
+	return !multirate && cache.isOpen() && cache.getBinCount() == getBinCount();
+}
+
+// retrieve whether samples are still being decoded in the background
+bool Sound::isDecoding()
+{
+	// the flag is read first, a decoder finishing in between is then still counted as decoding
+	return !decoder.isComplete() && getReadyCount() < sampleCount;
+}
+
+// window and transform the samples starting at a sample frame, returns
+// false if the window runs past the samples that are ready to be read
+bool Sound::analyze(std::size_t framePos, const AnalysisPlan &plan, std::vector<std::complex<double>> &bins)
+{
+	const std::size_t start{ framePos * channelCount };
+	if (channelCount == 0 || (start + plan.fftSize * channelCount) > getReadyCount())
+	{
+		return false;
+	}
+
+	// retrieve current sample data and apply hann window, float
+	// samples are brought to the 16-bit range to keep magnitudes equal
+	if (floatSamples)
+	{
+		SampleKernel::windowSamples(floatSamples + start, channelCount, 32768.0, plan.window, bins);
+	}
+	else
+	{
+		SampleKernel::windowSamples(int16Samples + start, channelCount, 1.0, plan.window, bins);
+	}
+	// apply FFT
+	FFT::forward(bins);
+	return true;
+}
+
+// analyze with the multirate analyzer, centering its input on the
+// same instant as the single FFT window starting at framePos
+bool Sound::analyzeMultirate(std::size_t framePos)
+{
+	const std::size_t inputLength{ static_cast<std::size_t>(multirate->getInputLength()) };
+	const std::size_t center{ framePos + fftSize / 2 };
+	const std::size_t start{ center > inputLength / 2 ? center - inputLength / 2 : 0 };
+	if (channelCount == 0 || (start + inputLength) * channelCount > getReadyCount())
+	{
+		return false;
+	}
+
+	monoSamples.resize(inputLength);
+	if (floatSamples)
+	{
+		SampleKernel::downmixSamples(floatSamples + start * channelCount, channelCount, 32768.0, inputLength, monoSamples.data());
+	}
+	else
+	{
+		SampleKernel::downmixSamples(int16Samples + start * channelCount, channelCount, 1.0, inputLength, monoSamples.data());
+	}
+	multirate->analyze(monoSamples.data(), magnitudes);
+	currentMagnitudes = magnitudes.data();
+	return true;
+}
+
+// map the spectrogram cache for this sound. Hashing the file and building
+// a missing cache (or one made with different parameters) both happen on a
+// background thread, so playback starts right away; update() maps the cache
+// once it is found or written. Returns false if no cache can be made.
+bool Sound::loadCache(const std::string &cachePath, int hopSize)
+{
+	if (cacheBuilder.joinable())
+	{
+		return false;
+	}
+
+	SpectrogramCache::Header expected{ SpectrogramCache::makeHeader() };
+	expected.fftSize = fftSize;
+	expected.hopSize = hopSize;
+	expected.windowType = SpectrogramCache::Hann;
+	expected.sampleRate = sampleRate;
+	expected.channelCount = channelCount;
+	expected.binCount = static_cast<std::uint32_t>(magnitudes.size());
+	if (hopSize <= 0 || channelCount == 0)
+	{
+		std::cerr << "Sound::loadCache(): unable to key cache for " << soundPath << '\n';
+		return false;
+	}
+
+	const std::size_t frameLength{ sampleCount / channelCount };
+	if (frameLength < static_cast<std::size_t>(fftSize))
+	{
+		return false;
+	}
+	expected.frameCount = (frameLength - fftSize) / hopSize + 1;
+	this->cachePath = cachePath;
+	cachePlan = plan;
+	cacheHeader = expected;
+	cacheBuilder = std::thread(&Sound::buildCache, this);
+	return true;
+}
+
+// key the cache by the file's content, then use the existing cache or
+// derive every frame once and write it to disk
+void Sound::buildCache()
+{
+	// hashing reads the whole file, which is why it is not done before playback
+	cacheHeader.contentHash = SpectrogramCache::hashFile(soundPath);
+	if (cacheHeader.contentHash == 0)
+	{
+		std::cerr << "Sound::buildCache(): unable to key cache for " << soundPath << '\n';
+		return;
+	}
+	{
+		SpectrogramCache existing;
+		if (existing.open(cachePath, cacheHeader))
 		{
+			cacheReady = true;
 			return;
 		}
-		for (int x{ samplePos }, y{ 0 }; x < (samplePos + fftSize * 2); x += 2, ++y)
-		{
-			// average stereo data: left and right samples are interleaved
-			double sampleAverage{ (soundBuffer.getSamples()[x] + soundBuffer.getSamples()[x + 1]) / 2.0 };
-			fftBins[y] = sampleAverage * hannWindow[y];
-		}
 	}
-	// assuming mono input
-	else
+
+	// wait for the decoder so every window is available
+	while (getReadyCount() < sampleCount)
 	{
-		// retrieve current sample data and apply hann window
-		samplePos = static_cast<int>((sound.getPlayingOffset().asSeconds()) * sampleRate);
-		if ((samplePos + fftSize) >= sampleCount)
+		if (cacheCancelled || (decoder.isComplete() && decoder.getReadyCount() < sampleCount))
 		{
 			return;
 		}
-		for (int x{ samplePos }, y{ 0 }; x < (samplePos + fftSize); ++x, ++y)
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	// the builder has its own buffers and plan so playback analysis can continue, even at another size
+	std::vector<std::complex<double>> bins(cachePlan->fftSize);
+	std::vector<float> frameMagnitudes(cacheHeader.binCount);
+	std::vector<float> frames;
+	frames.reserve(static_cast<std::size_t>(cacheHeader.frameCount) * frameMagnitudes.size());
+	for (std::uint64_t frame{ 0 }; frame < cacheHeader.frameCount; ++frame)
+	{
+		if (cacheCancelled)
 		{
-			fftBins[y] = soundBuffer.getSamples()[x] * hannWindow[y];
+			return;
 		}
+		analyze(static_cast<std::size_t>(frame) * cacheHeader.hopSize, *cachePlan, bins);
+		SpectrumKernel::convert(bins.data(), static_cast<int>(frameMagnitudes.size()), s_rawMagnitudes, frameMagnitudes.data());
+		frames.insert(frames.end(), frameMagnitudes.begin(), frameMagnitudes.end());
+	}
+
+	if (SpectrogramCache::write(cachePath, cacheHeader, frames))
+	{
+		cacheReady = true;
 	}
-	// apply FFT
-	FFT::forward(fftBins);
 }
 
 // play sound
 void Sound::play()
 {
-	sound.play();
+	stream.play();
 }
 
 // pause sound
 void Sound::pause()
 {
-	sound.pause();
+	stream.pause();
 }
 
 // stop sound and reset playing position
 void Sound::stop()
 {
-	sound.stop();
+	stream.cancelWait();
+	stream.stop();
+	clock.reset();
 }
 
 void Sound::toggle()
 {
-	if (sound.getStatus() == sf::Sound::Playing)
+	if (stream.getStatus() == sf::SoundStream::Playing)
 	{
-		sound.pause();
+		stream.pause();
 	}
 
 	else
 	{
-		sound.play();
+		stream.play();
 	}
 }
 
 // set whether the sound should loop at the end
 void Sound::setLoop(bool loop)
 {
-	sound.setLoop(loop);
+	stream.setLoop(loop);
 }
 
 // set volume of sound (0 through 100)
 void Sound::setVolume(float volume)
 {
-	sound.setVolume(volume);
+	stream.setVolume(volume);
+}
+
+// seek to a position in seconds
+void Sound::setPlayingOffset(float seconds)
+{
+	stream.cancelWait();
+	stream.setPlayingOffset(sf::seconds(seconds));
+	clock.reset();
+}
+
+// set the device latency subtracted from the playing position, so the
+// analyzed window matches what is heard rather than what was last queued
+void Sound::setOutputLatency(float seconds)
+{
+	clock.setLatency(seconds);
+}
+
+// analyze low octaves at reduced sample rates with small FFTs instead of
+// one full rate FFT, giving the same low frequency resolution for less work
+void Sound::setMultirate(bool enabled)
+{
+	// the next update analyzes again, even at the same position
+	analyzedPos = s_notAnalyzed;
+	if (!enabled)
+	{
+		multirate = nullptr;
+		return;
+	}
+	std::unique_ptr<MultirateAnalyzer> &analyzer{ multirateAnalyzers[plan - plans.data()] };
+	if (!analyzer && sampleRate > 0)
+	{
+		// each level halves the rate, so the deepest level matches
+		// the bin spacing of the full size FFT
+		analyzer.reset(new MultirateAnalyzer(s_multirateLevels, fftSize >> (s_multirateLevels - 1), sampleRate));
+		analyzer->setFrequencies(std::vector<double>(binFreq.begin(), binFreq.begin() + magnitudes.size()));
+	}
+	multirate = analyzer.get();
+}
+
+// switch to another FFT size. Windows are prebuilt and the buffers were
+// reserved for the largest size, so only lengths and bin frequencies change
+bool Sound::setFftSize(int fftSize)
+{
+	if (fftSize == this->fftSize)
+	{
+		return true;
+	}
+	const auto found = std::find_if(plans.begin(), plans.end(), [fftSize](const AnalysisPlan &candidate) { return candidate.fftSize == fftSize; });
+	if (found == plans.end())
+	{
+		std::cerr << "Sound::setFftSize(): no plan for FFT size " << fftSize << '\n';
+		return false;
+	}
+
+	const bool multirateEnabled{ multirate != nullptr };
+	plan = &*found;
+	this->fftSize = fftSize;
+	freqRes = static_cast<double>(sampleRate) / fftSize;
+	binFreq.resize(fftSize);
+	for (int x{ 0 }; x < fftSize; ++x)
+	{
+		binFreq[x] = x * freqRes;
+	}
+	fftBins.resize(fftSize);
+	channelBins.resize(fftSize);
+	magnitudes.resize(fftSize / 2);
+	currentMagnitudes = magnitudes.data();
+	setMultirate(multirateEnabled);
+	analyzedPos = s_notAnalyzed;
+	return true;
+}
+
+// retrieve whether the multirate analyzer is used
+bool Sound::getMultirate()
+{
+	return multirate != nullptr;
 }
 
 // retrieve looping status
 bool Sound::getLoop()
 {
-	return sound.getLoop();
+	return stream.getLoop();
 }
 
 // retrieve sound volume (0 through 100)
 float Sound::getVolume()
 {
-	return sound.getVolume();
+	return stream.getVolume();
 }
 
 // retrieve amount of seconds since the sound started
 float Sound::getPlayingOffset()
 {
-	return sound.getPlayingOffset().asSeconds();
+	return stream.getPlayingOffset().asSeconds();
+}
+
+// retrieve the device latency in seconds
+float Sound::getOutputLatency()
+{
+	return static_cast<float>(clock.getLatency());
 }
 
 // retrieve sample rate of sound in Hz
@@ -144,7 +518,7 @@ int Sound::getSampleRate()
 }
 
 // retrieve the amount of samples in the sound
-int Sound::getSampleCount()
+std::size_t Sound::getSampleCount()
 {
 	return sampleCount;
 }
@@ -158,11 +532,77 @@ int Sound::getChannelCount()
 // retrieve the total duration of the sound in seconds
 float Sound::getDuration()
 {
-	return soundBuffer.getDuration().asSeconds();
+	return channelCount > 0 ? static_cast<float>(sampleCount / channelCount) / sampleRate : 0.0f;
+}
+
+// retrieve the amount of samples that can be read from the start of the sound
+std::size_t Sound::getReadyCount()
+{
+	return pcm.isOpen() ? sampleCount : std::min(decoder.getReadyCount(), sampleCount);
+}
+
+// block until the whole sound is decoded
+void Sound::waitForDecode()
+{
+	if (!pcm.isOpen())
+	{
+		decoder.wait();
+	}
+}
+
+// retrieve the amount of magnitude bins (fftSize / 2)
+int Sound::getBinCount()
+{
+	return static_cast<int>(magnitudes.size());
+}
+
+// retrieve the current FFT size
+int Sound::getFftSize()
+{
+	return fftSize;
+}
+
+// convert count bins starting at firstBin to display levels in one pass
+void Sound::getLevels(const SpectrumKernel::Params &params, int firstBin, int count, float* levelsOut)
+{
+	count = std::max(std::min(count, static_cast<int>(magnitudes.size()) - firstBin), 0);
+	if (currentMagnitudes)
+	{
+		SpectrumKernel::convert(currentMagnitudes + firstBin, count, params, levelsOut);
+	}
+	else
+	{
+		SpectrumKernel::convert(fftBins.data() + firstBin, count, params, levelsOut);
+	}
+}
+
+// transform one channel at the analysis position and convert count bins to
+// display levels, returns false if its samples are not decoded yet
+bool Sound::getChannelLevels(int channel, const SpectrumKernel::Params &params, int firstBin, int count, float* levelsOut)
+{
+	const std::size_t start{ samplePos * channelCount };
+	if (channel < 0 || channel >= channelCount || (start + fftSize * channelCount) > getReadyCount())
+	{
+		return false;
+	}
+
+	if (floatSamples)
+	{
+		SampleKernel::windowChannel(floatSamples + start, channelCount, channel, 32768.0, plan->window, channelBins);
+	}
+	else
+	{
+		SampleKernel::windowChannel(int16Samples + start, channelCount, channel, 1.0, plan->window, channelBins);
+	}
+	FFT::forward(channelBins);
+
+	count = std::max(std::min(count, static_cast<int>(magnitudes.size()) - firstBin), 0);
+	SpectrumKernel::convert(channelBins.data() + firstBin, count, params, levelsOut);
+	return true;
 }
 
 // retrieve the status of the sound (playing/paused/stopped)
 sf::SoundSource::Status Sound::getStatus()
 {
-	return sound.getStatus();
+	return stream.getStatus();
 }
\ No newline at end of file
@@ -4,8 +4,18 @@
 #include <string>
 #include <vector>
 #include <complex>
+#include <atomic>
+#include <thread>
+#include <memory>
 #include <SFML/Audio.hpp>
 #include "fft.h"
+#include "spectrogram_cache.h"
+#include "mapped_pcm.h"
+#include "pcm_stream.h"
+#include "progressive_decoder.h"
+#include "multirate.h"
+#include "spectrum_kernel.h"
+#include "playback_clock.h"
 
 class Sound
 {
@@ -13,20 +23,44 @@ public:
 	// constructor
 	Sound(const std::string &soundPath, int fftSize);
 
-	void  update();					// update frequency bins
+	// destructor
+	~Sound();
+
+	bool  update();					// update frequency bins, returns true if they changed
+	bool  update(std::size_t framePos);	// update frequency bins at a sample frame instead of the playing position
+	bool  isAnalysisPending();		// retrieve whether the position waits for its samples to be decoded
+	bool  isCached();				// retrieve whether update() reads the current FFT size from the cache
+	void  waitForDecode();			// block until the whole sound is decoded
+	bool  loadCache(const std::string &cachePath, int hopSize);	// map or build the on-disk spectrogram cache
 	void  play();					// play sound
 	void  pause();					// pause sound
 	void  stop();					// stop sound and reset playing position
 	void  toggle();					// toggle playing / paused status
 	void  setLoop(bool loop);		// set whether the sound should loop at the end
 	void  setVolume(float volume);	// set volume of sound (0 through 100)
+	void  setPlayingOffset(float seconds);	// seek to a position in seconds
+	void  setOutputLatency(float seconds);	// set the device latency subtracted from the playing position
+	void  setMultirate(bool enabled);	// set whether low octaves are analyzed at reduced sample rates
+	bool  setFftSize(int fftSize);	// switch to another pooled FFT size, bins change with it
+	bool  getMultirate();			// retrieve whether the multirate analyzer is used
 	bool  getLoop();				// retrieve looping status
 	float getVolume();				// retrieve sound volume (0 through 100)
 	float getPlayingOffset();		// retrieve amount of seconds since the sound started
+	float getOutputLatency();		// retrieve the device latency in seconds
 	int   getSampleRate();			// retrieve sample rate of sound in Hz
-	int   getSampleCount();			// retrieve the amount of samples in the sound
+	std::size_t getSampleCount();	// retrieve the amount of samples in the sound
+	std::size_t getReadyCount();	// retrieve the amount of samples decoded so far
 	int   getChannelCount();		// retrieve the amount of channels in the sound
 	float getDuration();			// retrieve the total duration of the sound in seconds
+	int   getBinCount();			// retrieve the amount of magnitude bins (fftSize / 2)
+	int   getFftSize();				// retrieve the current FFT size
+
+	// convert count bins starting at firstBin to display levels in one pass
+	void  getLevels(const SpectrumKernel::Params &params, int firstBin, int count, float* levelsOut);
+
+	// transform one channel at the analysis position and convert count bins to
+	// display levels, returns false if its samples are not decoded yet
+	bool  getChannelLevels(int channel, const SpectrumKernel::Params &params, int firstBin, int count, float* levelsOut);
 
 									// retrieve the status of the sound (playing/paused/stopped)
 	sf::SoundSource::Status getStatus();
@@ -37,19 +71,76 @@ public:
 	// complex vector containing the frequencies of each frequency bin
 	std::vector<double> binFreq;
 
+	// smallest and largest FFT size setFftSize() accepts
+	static const int s_minFftSize;
+	static const int s_maxFftSize;
+
 private:
+	// window of one FFT size, every size is built once up front so
+	// switching sizes (and the cache builder) never allocate or race
+	struct AnalysisPlan
+	{
+		int fftSize;
+		std::vector<double> window;
+	};
+
+	// window and transform the samples starting at a sample frame
+	bool analyze(std::size_t framePos, const AnalysisPlan &plan, std::vector<std::complex<double>> &bins);
+	bool analyzeMultirate(std::size_t framePos);	// analyze around the same instant with the multirate analyzer
+	bool isDecoding();				// retrieve whether samples are still being decoded in the background
+	void buildCache();				// hash the file, then find or derive and write the spectrogram cache
+
+	static const std::size_t s_notAnalyzed;
+	static const float s_initialDecodeSeconds;
+	static const int s_multirateLevels;
+	static const SpectrumKernel::Params s_rawMagnitudes;
+
+	std::string soundPath;
 	int sampleRate;
-	int sampleCount;
-	int samplePos;
+	std::size_t sampleCount;
+	std::size_t samplePos;
+	std::size_t analyzedPos;		// sample frame the current bins belong to
 	int channelCount;
 	int fftSize;
 	double freqRes;
 
-	// vector containing hann window multipliers
-	std::vector<double> hannWindow;
+	// hann windows of every FFT size, the current one and the one the cache is built with
+	std::vector<AnalysisPlan> plans;
+	const AnalysisPlan* plan;
+	const AnalysisPlan* cachePlan;
+
+	// bins of the last single channel transform
+	std::vector<std::complex<double>> channelBins;
+
+	// magnitudes of the last multirate analysis, and the magnitudes levels
+	// are read from (the cache, this vector, or nullptr for fftBins)
+	std::vector<float> magnitudes;
+	const float* currentMagnitudes;
+
+	// multirate analyzers created per FFT size on first use, the current
+	// one (null when disabled) and their downmixed input
+	std::vector<std::unique_ptr<MultirateAnalyzer>> multirateAnalyzers;
+	MultirateAnalyzer* multirate;
+	std::vector<double> monoSamples;
+
+	SpectrogramCache cache;
+	SpectrogramCache::Header cacheHeader;
+	std::string cachePath;
+	std::thread cacheBuilder;
+	std::atomic<bool> cacheReady;		// set by the background thread once the cache can be mapped
+	std::atomic<bool> cacheCancelled;
+
+	// interleaved sample view used for analysis and playback, it points
+	// into either the mapped file or the decoded samples
+	const sf::Int16* int16Samples;
+	const float* floatSamples;
+
+	MappedPcm pcm;
+	ProgressiveDecoder decoder;
+	PcmStream stream;
 
-	sf::SoundBuffer soundBuffer;
-	sf::Sound sound;
+	// interpolates the playing offset between device updates
+	PlaybackClock clock;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "spectrogram_cache.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+// version of the cache file format, bump when the layout changes
+const std::uint32_t SpectrogramCache::s_version{ 1 };
+
+// default constructor
+SpectrogramCache::SpectrogramCache() : header(makeHeader()), frames{ nullptr }
+{
+}
+
+// returns a header with magic and version filled in
+SpectrogramCache::Header SpectrogramCache::makeHeader()
+{
+	Header emptyHeader;
+	std::memset(&emptyHeader, 0, sizeof(emptyHeader));
+	std::memcpy(emptyHeader.magic, "ASPC", 4);
+	emptyHeader.version = s_version;
+	return emptyHeader;
+}
+
+// maps a cache file and validates its header against the expected parameters
+bool SpectrogramCache::open(const std::string &path, const Header &expected)
+{
+	close();
+	if (!file.open(path))
+	{
+		return false;
+	}
+
+	if (file.getSize() < sizeof(Header))
+	{
+		std::cerr << "SpectrogramCache::open(): cache file is truncated\n";
+		close();
+		return false;
+	}
+	std::memcpy(&header, file.getData(), sizeof(Header));
+
+	// reject caches built with a different format or analysis parameters
+	if (std::memcmp(header.magic, "ASPC", 4) != 0 ||
+		header.version != s_version ||
+		header.fftSize != expected.fftSize ||
+		header.hopSize != expected.hopSize ||
+		header.windowType != expected.windowType ||
+		header.sampleRate != expected.sampleRate ||
+		header.channelCount != expected.channelCount ||
+		header.binCount != expected.binCount ||
+		header.contentHash != expected.contentHash)
+	{
+		close();
+		return false;
+	}
+
+	const std::uint64_t payloadSize{ header.frameCount * header.binCount * sizeof(float) };
+	if (header.frameCount == 0 || file.getSize() - sizeof(Header) < payloadSize)
+	{
+		std::cerr << "SpectrogramCache::open(): cache file is truncated\n";
+		close();
+		return false;
+	}
+
+	frames = reinterpret_cast<const float*>(file.getData() + sizeof(Header));
+	return true;
+}
+
+// writes a cache file containing the supplied frames
+bool SpectrogramCache::write(const std::string &path, const Header &header, const std::vector<float> &frames)
+{
+	if (frames.size() != header.frameCount * header.binCount)
+	{
+		std::cerr << "SpectrogramCache::write(): frame data does not match header\n";
+		return false;
+	}
+
+	std::ofstream cacheFile(path, std::ios::binary | std::ios::trunc);
+	if (!cacheFile)
+	{
+		std::cerr << "SpectrogramCache::write(): unable to open " << path << '\n';
+		return false;
+	}
+	cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	cacheFile.write(reinterpret_cast<const char*>(frames.data()), frames.size() * sizeof(float));
+	if (!cacheFile)
+	{
+		std::cerr << "SpectrogramCache::write(): unable to write " << path << '\n';
+		return false;
+	}
+	return true;
+}
+
+// computes a 64-bit FNV-1a hash of a file's contents, 0 on failure
+std::uint64_t SpectrogramCache::hashFile(const std::string &path)
+{
+	MappedFile source;
+	if (!source.open(path))
+	{
+		return 0;
+	}
+
+	std::uint64_t hash{ 14695981039346656037ULL };
+	const unsigned char* bytes{ source.getData() };
+	for (std::size_t x{ 0 }; x < source.getSize(); ++x)
+	{
+		hash ^= bytes[x];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+// unmap the cache
+void SpectrogramCache::close()
+{
+	file.close();
+	frames = nullptr;
+	header.frameCount = 0;
+}
+
+// retrieve whether a cache is mapped
+bool SpectrogramCache::isOpen() const
+{
+	return frames != nullptr;
+}
+
+// retrieve magnitudes of a frame (clamped to valid range)
+const float* SpectrogramCache::getFrame(int frame) const
+{
+	if (frame < 0)
+	{
+		frame = 0;
+	}
+	else if (static_cast<std::uint64_t>(frame) >= header.frameCount)
+	{
+		frame = static_cast<int>(header.frameCount - 1);
+	}
+	return frames + static_cast<std::size_t>(frame) * header.binCount;
+}
+
+// retrieve number of frames in the cache
+int SpectrogramCache::getFrameCount() const
+{
+	return static_cast<int>(header.frameCount);
+}
+
+// retrieve number of bins per frame
+int SpectrogramCache::getBinCount() const
+{
+	return static_cast<int>(header.binCount);
+}
+
+// retrieve hop size in sample frames
+int SpectrogramCache::getHopSize() const
+{
+	return static_cast<int>(header.hopSize);
+}
@@ -0,0 +1,73 @@
+#ifndef SPECTROGRAM_CACHE_H
+#define SPECTROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+/*
+	On-disk spectrogram cache. A cache file holds a fixed size header
+	followed by frameCount * binCount 32-bit float magnitudes, stored
+	frame by frame. Frame k is the spectrum of the window that starts
+	at sample frame k * hopSize of the source audio.
+
+	The file is written once and memory-mapped on later runs, so reading
+	a frame is a pointer offset into the page cache.
+*/
+class SpectrogramCache
+{
+public:
+	static const std::uint32_t s_version;
+
+	enum WindowType : std::uint32_t
+	{
+		Hann = 0
+	};
+
+	// binary layout of the cache file header (little endian)
+	struct Header
+	{
+		char magic[4];
+		std::uint32_t version;
+		std::uint32_t fftSize;
+		std::uint32_t hopSize;
+		std::uint32_t windowType;
+		std::uint32_t sampleRate;
+		std::uint32_t channelCount;
+		std::uint32_t binCount;
+		std::uint64_t frameCount;
+		std::uint64_t contentHash;
+	};
+
+	// default constructor
+	SpectrogramCache();
+
+	// maps a cache file and validates its header against the expected
+	// parameters (frameCount is not compared). Returns false if the
+	// file is missing, stale or malformed.
+	bool open(const std::string &path, const Header &expected);
+
+	// writes a cache file containing the supplied frames
+	static bool write(const std::string &path, const Header &header, const std::vector<float> &frames);
+
+	// returns a header with magic and version filled in
+	static Header makeHeader();
+
+	// computes a 64-bit FNV-1a hash of a file's contents, 0 on failure
+	static std::uint64_t hashFile(const std::string &path);
+
+	void close();							// unmap the cache
+	bool isOpen() const;					// retrieve whether a cache is mapped
+	const float* getFrame(int frame) const;	// retrieve magnitudes of a frame (clamped to valid range)
+	int getFrameCount() const;				// retrieve number of frames in the cache
+	int getBinCount() const;				// retrieve number of bins per frame
+	int getHopSize() const;					// retrieve hop size in sample frames
+
+private:
+	Header header;
+	MappedFile file;
+	const float* frames;
+};
+
+#endif
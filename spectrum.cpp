@@ -1,49 +1,214 @@
 #include "spectrum.h"
 #include "window.h"
 
-Spectrum::Spectrum(int length, GLfloat spacing) : length{ length }
+#include <algorithm>
+#include <cmath>
+
+// bottom edge of the bars in pixels
+const GLfloat Spectrum::s_baseline{ 100.0f };
+
+// space left and right of the bars in pixels
+const GLfloat Spectrum::s_margin{ 75.0f };
+
+// one bar per display band, evenly spaced across the window with
+// spacing pixels between neighbouring bars
+Spectrum::Spectrum(int bandCount, GLfloat spacing)
+	: bandCount{ bandCount }, spacing{ spacing }, viewportWidth{ 0 }, viewportHeight{ 0 }, aggregateMode{ Max },
+	drawnBarCount{ bandCount }, mode{ Bars }, subdivisions{ 8 }, firstBar{ 0 }
 {
-	GLfloat freqRes = static_cast<GLfloat>(44100.0 / (length * 2));
-	std::vector<GLfloat> positions(length - 1, 0.0f);
-	std::vector<GLfloat> barWidths(length - 1, 0.0f);
+	// the layout only changes with the viewport, so it is kept in uniforms
+	program.loadProgram("bars.vert", "basic.frag");
+	program.use();
+	glUniform1i(glGetUniformLocation(program.getProgram(), "heights"), 0);
+	glUniform2f(glGetUniformLocation(program.getProgram(), "viewport"), static_cast<GLfloat>(Window::width), static_cast<GLfloat>(Window::height));
+	glUniform1f(glGetUniformLocation(program.getProgram(), "baseline"), s_baseline);
+	glUniform1f(glGetUniformLocation(program.getProgram(), "left"), s_margin);
+	firstBarLocation = glGetUniformLocation(program.getProgram(), "firstBar");
+	stepLocation = glGetUniformLocation(program.getProgram(), "step");
+	barWidthLocation = glGetUniformLocation(program.getProgram(), "barWidth");
 
-	for (int bin{ 1 }; bin < length; ++bin)
-	{
-		positions[bin - 1] = log10f(static_cast<GLfloat>(bin));
-	}
+	curveProgram.loadProgram("curve.vert", "basic.frag");
+	curveProgram.use();
+	glUniform1i(glGetUniformLocation(curveProgram.getProgram(), "heights"), 0);
+	glUniform2f(glGetUniformLocation(curveProgram.getProgram(), "viewport"), static_cast<GLfloat>(Window::width), static_cast<GLfloat>(Window::height));
+	glUniform1f(glGetUniformLocation(curveProgram.getProgram(), "baseline"), s_baseline);
+	glUniform1f(glGetUniformLocation(curveProgram.getProgram(), "left"), s_margin);
+	curveFirstBarLocation = glGetUniformLocation(curveProgram.getProgram(), "firstBar");
+	curveBarCountLocation = glGetUniformLocation(curveProgram.getProgram(), "barCount");
+	curveStepLocation = glGetUniformLocation(curveProgram.getProgram(), "step");
+	curveBarWidthLocation = glGetUniformLocation(curveProgram.getProgram(), "barWidth");
+	curveSubdivisionsLocation = glGetUniformLocation(curveProgram.getProgram(), "subdivisions");
+	curveFilledLocation = glGetUniformLocation(curveProgram.getProgram(), "filled");
+	glUniform1i(curveSubdivisionsLocation, subdivisions);
+	glUseProgram(0);
+	setViewport(Window::width, Window::height);
 
-	GLfloat scale{ (Window::width - 150.0f) / positions[positions.size() - 1] };
+	// core profile draws need a vertex array object, even an empty one
+	VAO = GLCreate::vertexArray();
 
-	for (unsigned int x{ 0 }; x < positions.size(); ++x)
+	// heights are fetched by index from a buffer texture over the whole ring
+	heightBuffer.create(bandCount * sizeof(GLfloat));
+	heightTexture = GLCreate::texture();
+	glBindTexture(GL_TEXTURE_BUFFER, heightTexture.get());
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, heightBuffer.getBuffer());
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+// stream bandCount bar heights in pixels
+void Spectrum::update(const GLfloat* heights)
+{
+	if (!groupStart.empty())
 	{
-		positions[x] = positions[x] * scale + 75.0f;
+		aggregate(heights);
+		heights = groupHeights.data();
 	}
 
-	for (unsigned int x{ 0 }; x < barWidths.size() - 1; ++x)
+	const GLintptr offset{ heightBuffer.write(heights, drawnBarCount * sizeof(GLfloat)) };
+	if (offset >= 0)
 	{
-		barWidths[x] = positions[x + 1] - positions[x];
+		firstBar = static_cast<GLint>(offset / sizeof(GLfloat));
 	}
-	barWidths[barWidths.size() - 1] = barWidths[barWidths.size() - 2];
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
-	const GLfloat step{ Window::width / static_cast<GLfloat>(length) };
-	for (int count{ 0 }; count < length - 1; ++count)
+// draw the heights in the current mode with one call
+void Spectrum::draw()
+{
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_BUFFER, heightTexture.get());
+	glBindVertexArray(VAO.get());
+	if (mode == Bars)
+	{
+		program.use();
+		glUniform1i(firstBarLocation, firstBar);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, drawnBarCount);
+	}
+	else
 	{
-		bars.push_back(Bar(barWidths[count], 300.0f, positions[count], 100.0f));
+		// one point per subdivision between neighbouring bar centers, plus the last center
+		const GLsizei pointCount{ (drawnBarCount - 1) * subdivisions + 1 };
+		curveProgram.use();
+		glUniform1i(curveFirstBarLocation, firstBar);
+		glUniform1i(curveBarCountLocation, drawnBarCount);
+		glUniform1i(curveFilledLocation, mode == Area);
+		if (mode == Area)
+		{
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 2 * pointCount);
+		}
+		else
+		{
+			glDrawArrays(GL_LINE_STRIP, 0, pointCount);
+		}
 	}
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	// the heights segment may be rewritten once this draw completes
+	heightBuffer.fence();
 }
 
-void Spectrum::update()
+// regroup bars for a viewport of width x height pixels, only when the size changed
+void Spectrum::setViewport(int width, int height)
 {
-	for (unsigned int count{ 0 }; count < bars.size(); ++count)
+	if (width == viewportWidth && height == viewportHeight)
 	{
-		bars[count].update();
+		return;
 	}
+	viewportWidth = width;
+	viewportHeight = height;
+
+	// bands are already spaced on a perceptual frequency scale,
+	// so bars share the width between the margins evenly
+	const GLfloat span{ Window::width - 2.0f * s_margin };
+	GLfloat step{ span / bandCount };
+	GLfloat barWidth{ std::max(step - spacing, 1.0f) };
+
+	// layout is in window units, the viewport scales them to pixels
+	const GLfloat pixelsPerUnit{ static_cast<GLfloat>(width) / Window::width };
+	const int columns{ std::max(static_cast<int>(std::floor(span * pixelsPerUnit)), 1) };
+	groupStart.clear();
+	drawnBarCount = bandCount;
+	if (columns < bandCount)
+	{
+		// one group per pixel column, each starting at the first bar whose
+		// left edge lies in that column
+		for (int column{ 0 }; column <= columns; ++column)
+		{
+			groupStart.push_back(static_cast<int>(static_cast<long long>(column) * bandCount / columns));
+		}
+		groupHeights.resize(columns);
+		drawnBarCount = columns;
+		step = span / columns;
+		barWidth = step;
+	}
+
+	program.use();
+	glUniform1f(stepLocation, step);
+	glUniform1f(barWidthLocation, barWidth);
+	curveProgram.use();
+	glUniform1f(curveStepLocation, step);
+	glUniform1f(curveBarWidthLocation, barWidth);
+	glUseProgram(0);
 }
 
-void Spectrum::draw()
+// set how merged bars combine
+void Spectrum::setAggregate(Aggregate aggregate)
+{
+	aggregateMode = aggregate;
+}
+
+// set how the heights are drawn
+void Spectrum::setMode(Mode mode)
+{
+	this->mode = mode;
+}
+
+// set curve points per bar, 1 draws straight segments
+void Spectrum::setSubdivisions(int subdivisions)
+{
+	this->subdivisions = std::max(subdivisions, 1);
+	curveProgram.use();
+	glUniform1i(curveSubdivisionsLocation, this->subdivisions);
+	glUseProgram(0);
+}
+
+// retrieve how the heights are drawn
+Spectrum::Mode Spectrum::getMode() const
 {
-	for (unsigned int count{ 0 }; count < bars.size(); ++count)
+	return mode;
+}
+
+// merge heights of each group into groupHeights
+void Spectrum::aggregate(const GLfloat* heights)
+{
+	for (int group{ 0 }; group < drawnBarCount; ++group)
 	{
-		bars[count].draw();
+		const GLfloat* first{ heights + groupStart[group] };
+		const GLfloat* last{ heights + groupStart[group + 1] };
+		if (aggregateMode == Max)
+		{
+			groupHeights[group] = *std::max_element(first, last);
+		}
+		else
+		{
+			GLfloat sum{ 0.0f };
+			for (const GLfloat* height{ first }; height != last; ++height)
+			{
+				sum += *height * *height;
+			}
+			groupHeights[group] = std::sqrt(sum / (last - first));
+		}
 	}
+}
+
+// retrieve the amount of bars
+int Spectrum::getBandCount() const
+{
+	return bandCount;
+}
+
+// retrieve the amount of bars drawn after merging
+int Spectrum::getDrawnBarCount() const
+{
+	return drawnBarCount;
 }
\ No newline at end of file
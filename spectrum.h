@@ -3,19 +3,105 @@
 
 #include <glad/glad.h>
 #include <vector>
-#include "bar.h"
+#include "shader_program.h"
+#include "stream_buffer.h"
+#include "gl_handle.h"
 
+/*
+	Row of bars drawn with vertex pulling. The only per-frame data is
+	one height per bar, streamed into a buffer texture; the vertex shader
+	builds every quad from gl_VertexID and gl_InstanceID and places it
+	with the layout uniforms, so the whole spectrum is a single
+	glDrawArraysInstanced call with no vertex attributes.
+
+	When bars get narrower than a pixel of the viewport, neighbouring bars
+	are merged into one bar per pixel column, taking the maximum or RMS
+	of their heights, so the draw never has more instances than columns.
+
+	The same heights can instead be drawn as a line or a filled area
+	through the bar centers, again a single draw with no vertex data.
+	Points between bar centers come from a Catmull-Rom spline evaluated
+	in the vertex shader, so few bands still give a smooth curve. Both
+	programs are built up front and switching modes only changes which
+	one draws.
+*/
 class Spectrum
 {
 public:
-	Spectrum(int length, GLfloat spacing);
+	// how the heights are drawn
+	enum Mode
+	{
+		Bars,		// one quad per bar
+		Line,		// line strip through the bar centers
+		Area		// triangle strip filled from the curve down to the baseline
+	};
+
+	// how bars merged into one pixel column combine their heights
+	enum Aggregate
+	{
+		Max,		// tallest bar, keeps narrow peaks visible
+		Rms			// root mean square, keeps the energy of the column
+	};
+
+	// one bar per display band, evenly spaced across the window with
+	// spacing pixels between neighbouring bars
+	Spectrum(int bandCount, GLfloat spacing);
 
-	void update();
-	void draw();
-	std::vector<Bar> bars;
+	void update(const GLfloat* heights);	// stream bandCount bar heights in pixels
+	void draw();							// draw the heights in the current mode with one call
+
+	// regroup bars for a viewport of width x height pixels, only when the size changed
+	void setViewport(int width, int height);
+	void setAggregate(Aggregate aggregate);	// set how merged bars combine
+	void setMode(Mode mode);				// set how the heights are drawn
+	void setSubdivisions(int subdivisions);	// set curve points per bar, 1 draws straight segments
+
+	Mode getMode() const;					// retrieve how the heights are drawn
+
+	int getBandCount() const;				// retrieve the amount of bars
+	int getDrawnBarCount() const;			// retrieve the amount of bars drawn after merging
 
 private:
-	const int length;
+	static const GLfloat s_baseline;
+	static const GLfloat s_margin;
+
+	// merge heights of each group into groupHeights
+	void aggregate(const GLfloat* heights);
+
+	const int bandCount;
+	const GLfloat spacing;
+
+	int viewportWidth;
+	int viewportHeight;
+	Aggregate aggregateMode;
+
+	// first bar of every drawn group plus an end entry, empty when nothing is merged
+	std::vector<int> groupStart;
+	std::vector<GLfloat> groupHeights;
+	int drawnBarCount;
+
+	Mode mode;
+	int subdivisions;
+
+	ShaderProgram program;
+	GLint firstBarLocation;
+	GLint stepLocation;
+	GLint barWidthLocation;
+
+	ShaderProgram curveProgram;
+	GLint curveFirstBarLocation;
+	GLint curveBarCountLocation;
+	GLint curveStepLocation;
+	GLint curveBarWidthLocation;
+	GLint curveSubdivisionsLocation;
+	GLint curveFilledLocation;
+
+	// first height of the latest frame within the height buffer
+	GLint firstBar;
+
+	GLVertexArray VAO;
+	GLTexture heightTexture;
+	StreamBuffer heightBuffer;
 };
 
 #endif
\ No newline at end of file
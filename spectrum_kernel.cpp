@@ -0,0 +1,187 @@
+#include "spectrum_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPECTRUM_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace SpectrumKernel
+{
+	// coefficients of log2(1 + t) ~ t * (c1 + t * (c2 + t * (c3 + t * c4))) on [0, 1),
+	// fitted for minimum maximum error (1.03e-4 in exact arithmetic)
+	const float s_log2C1{ 1.43901515f };
+	const float s_log2C2{ -0.679948092f };
+	const float s_log2C3{ 0.325604171f };
+	const float s_log2C4{ -0.0847738236f };
+
+	// 10 log10(2) and 20 log10(2), converting log2 of power or magnitude to decibels
+	const float s_powerDecibels{ 3.01029996f };
+	const float s_magnitudeDecibels{ 6.02059991f };
+
+	// smallest value passed to the logarithm, keeps silent bins finite
+	const float s_logFloor{ 1e-30f };
+
+	/*
+		Approximates log2(x) for positive normal x with the exponent bits
+		and a degree 4 polynomial of the mantissa.
+	*/
+	float fastLog2(float x)
+	{
+		std::uint32_t bits;
+		std::memcpy(&bits, &x, sizeof(bits));
+		const float exponent{ static_cast<float>(static_cast<int>(bits >> 23) - 127) };
+		bits = (bits & 0x007FFFFF) | 0x3F800000;
+		float mantissa;
+		std::memcpy(&mantissa, &bits, sizeof(mantissa));
+		const float t{ mantissa - 1.0f };
+		return exponent + t * (s_log2C1 + t * (s_log2C2 + t * (s_log2C3 + t * s_log2C4)));
+	}
+
+	// scale a power value
+	inline float scalePower(float power, Scale scale)
+	{
+		switch (scale)
+		{
+		case Magnitude:
+			return std::sqrt(power);
+		case Decibel:
+			return s_powerDecibels * fastLog2(std::max(power, s_logFloor));
+		default:
+			return power;
+		}
+	}
+
+	// scale a magnitude value
+	inline float scaleMagnitude(float magnitude, Scale scale)
+	{
+		switch (scale)
+		{
+		case Power:
+			return magnitude * magnitude;
+		case Decibel:
+			return s_magnitudeDecibels * fastLog2(std::max(magnitude, s_logFloor));
+		default:
+			return magnitude;
+		}
+	}
+
+	// apply gain and offset, then clamp to [0, ceiling]
+	inline float finish(float value, const Params &params)
+	{
+		return std::min(std::max(value * params.gain + params.offset, 0.0f), params.ceiling);
+	}
+
+#ifdef SPECTRUM_KERNEL_SSE2
+	// four lane version of fastLog2()
+	inline __m128 fastLog2(__m128 x)
+	{
+		const __m128i bits{ _mm_castps_si128(x) };
+		const __m128 exponent{ _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127))) };
+		const __m128 mantissa{ _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000))) };
+		const __m128 t{ _mm_sub_ps(mantissa, _mm_set1_ps(1.0f)) };
+		__m128 poly{ _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s_log2C4), t), _mm_set1_ps(s_log2C3)) };
+		poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(s_log2C2));
+		poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(s_log2C1));
+		return _mm_add_ps(exponent, _mm_mul_ps(poly, t));
+	}
+
+	inline __m128 scalePower(__m128 power, Scale scale)
+	{
+		switch (scale)
+		{
+		case Magnitude:
+			return _mm_sqrt_ps(power);
+		case Decibel:
+			return _mm_mul_ps(_mm_set1_ps(s_powerDecibels), fastLog2(_mm_max_ps(power, _mm_set1_ps(s_logFloor))));
+		default:
+			return power;
+		}
+	}
+
+	inline __m128 scaleMagnitude(__m128 magnitude, Scale scale)
+	{
+		switch (scale)
+		{
+		case Power:
+			return _mm_mul_ps(magnitude, magnitude);
+		case Decibel:
+			return _mm_mul_ps(_mm_set1_ps(s_magnitudeDecibels), fastLog2(_mm_max_ps(magnitude, _mm_set1_ps(s_logFloor))));
+		default:
+			return magnitude;
+		}
+	}
+
+	inline __m128 finish(__m128 value, __m128 gain, __m128 offset, __m128 ceiling)
+	{
+		const __m128 scaled{ _mm_add_ps(_mm_mul_ps(value, gain), offset) };
+		return _mm_min_ps(_mm_max_ps(scaled, _mm_setzero_ps()), ceiling);
+	}
+#endif
+
+	/*
+		Converts complex frequency bins to display levels in a single pass.
+	*/
+	void convert(const std::complex<double>* bins, int count, const Params &params, float* levelsOut)
+	{
+		int x{ 0 };
+#ifdef SPECTRUM_KERNEL_SSE2
+		// complex<double> is laid out as {real, imaginary}
+		const double* data{ reinterpret_cast<const double*>(bins) };
+		const __m128 gain{ _mm_set1_ps(params.gain) };
+		const __m128 offset{ _mm_set1_ps(params.offset) };
+		const __m128 ceiling{ _mm_set1_ps(params.ceiling) };
+		for (; x + 4 <= count; x += 4)
+		{
+			const __m128d bin0{ _mm_loadu_pd(data + 2 * x) };
+			const __m128d bin1{ _mm_loadu_pd(data + 2 * x + 2) };
+			const __m128d bin2{ _mm_loadu_pd(data + 2 * x + 4) };
+			const __m128d bin3{ _mm_loadu_pd(data + 2 * x + 6) };
+
+			// gather real and imaginary parts of two bins per register
+			const __m128d real01{ _mm_unpacklo_pd(bin0, bin1) };
+			const __m128d imag01{ _mm_unpackhi_pd(bin0, bin1) };
+			const __m128d real23{ _mm_unpacklo_pd(bin2, bin3) };
+			const __m128d imag23{ _mm_unpackhi_pd(bin2, bin3) };
+			const __m128d power01{ _mm_add_pd(_mm_mul_pd(real01, real01), _mm_mul_pd(imag01, imag01)) };
+			const __m128d power23{ _mm_add_pd(_mm_mul_pd(real23, real23), _mm_mul_pd(imag23, imag23)) };
+			const __m128 power{ _mm_movelh_ps(_mm_cvtpd_ps(power01), _mm_cvtpd_ps(power23)) };
+
+			_mm_storeu_ps(levelsOut + x, finish(scalePower(power, params.scale), gain, offset, ceiling));
+		}
+#endif
+		for (; x < count; ++x)
+		{
+			const double real{ bins[x].real() };
+			const double imag{ bins[x].imag() };
+			const float power{ static_cast<float>(real * real + imag * imag) };
+			levelsOut[x] = finish(scalePower(power, params.scale), params);
+		}
+	}
+
+	/*
+		Converts precomputed magnitudes to display levels in a single pass.
+	*/
+	void convert(const float* magnitudes, int count, const Params &params, float* levelsOut)
+	{
+		int x{ 0 };
+#ifdef SPECTRUM_KERNEL_SSE2
+		const __m128 gain{ _mm_set1_ps(params.gain) };
+		const __m128 offset{ _mm_set1_ps(params.offset) };
+		const __m128 ceiling{ _mm_set1_ps(params.ceiling) };
+		for (; x + 4 <= count; x += 4)
+		{
+			const __m128 magnitude{ _mm_loadu_ps(magnitudes + x) };
+			_mm_storeu_ps(levelsOut + x, finish(scaleMagnitude(magnitude, params.scale), gain, offset, ceiling));
+		}
+#endif
+		for (; x < count; ++x)
+		{
+			levelsOut[x] = finish(scaleMagnitude(magnitudes[x], params.scale), params);
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef SPECTRUM_KERNEL_H
+#define SPECTRUM_KERNEL_H
+
+#include <complex>
+
+namespace SpectrumKernel
+{
+	enum Scale
+	{
+		Power,		// |x|^2
+		Magnitude,	// |x|
+		Decibel		// 20 log10 |x|
+	};
+
+	// conversion applied to every bin:
+	// level = min(max(scale(x) * gain + offset, 0), ceiling)
+	struct Params
+	{
+		Scale scale;
+		float gain;
+		float offset;
+		float ceiling;
+	};
+
+	/*
+		Converts complex frequency bins to display levels in a single
+		pass. Power is taken from the real and imaginary parts directly,
+		so there is no hypot() with overflow handling; magnitudes come
+		from a single precision square root. Uses SSE2 when available.
+
+		bins - bins to convert
+		count - amount of bins
+		params - scale, gain, offset and ceiling of the conversion
+		levelsOut - array to hold count levels
+	*/
+	void convert(const std::complex<double>* bins, int count, const Params &params, float* levelsOut);
+
+	/*
+		Converts precomputed magnitudes to display levels in a single
+		pass, with the same scales as the complex overload.
+
+		magnitudes - magnitudes to convert
+		count - amount of magnitudes
+		params - scale, gain, offset and ceiling of the conversion
+		levelsOut - array to hold count levels (may equal magnitudes)
+	*/
+	void convert(const float* magnitudes, int count, const Params &params, float* levelsOut);
+
+	/*
+		Approximates log2(x) for positive normal x with the exponent bits
+		and a degree 4 polynomial of the mantissa. Absolute error is below
+		1.1e-4 over the whole range, 6.4e-4 dB when used for decibels.
+	*/
+	float fastLog2(float x);
+}
+
+#endif
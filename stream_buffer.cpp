@@ -0,0 +1,108 @@
+#include "stream_buffer.h"
+
+#include <cstring>
+#include <iostream>
+
+// default constructor
+StreamBuffer::StreamBuffer()
+	: segmentSize{ 0 }, segmentCount{ 0 }, segment{ 0 }, orphanCount{ 0 }
+{
+}
+
+// allocates segmentCount segments of segmentSize bytes
+bool StreamBuffer::create(GLsizeiptr segmentSize, int segmentCount)
+{
+	if (segmentSize <= 0 || segmentCount < 1)
+	{
+		std::cerr << "StreamBuffer::create(): invalid segment size or count\n";
+		return false;
+	}
+
+	if (!buffer)
+	{
+		buffer = GLCreate::buffer();
+	}
+	this->segmentSize = segmentSize;
+	this->segmentCount = segmentCount;
+	segment = segmentCount - 1;
+	fences.clear();
+	fences.resize(segmentCount);
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+	glBufferData(GL_ARRAY_BUFFER, segmentSize * segmentCount, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return true;
+}
+
+// writes size bytes into the next free segment and returns its offset
+GLintptr StreamBuffer::write(const void* data, GLsizeiptr size)
+{
+	if (!buffer || size > segmentSize)
+	{
+		std::cerr << "StreamBuffer::write(): buffer not created or data larger than a segment\n";
+		return -1;
+	}
+
+	segment = (segment + 1) % segmentCount;
+	glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+
+	// poll the fence without waiting, a segment still in use means the
+	// GPU is more than segmentCount frames behind
+	if (fences[segment])
+	{
+		const GLenum status{ glClientWaitSync(fences[segment].get(), 0, 0) };
+		if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED)
+		{
+			// orphan the storage, the driver keeps the old one alive for
+			// pending draws and every segment of the new one is free
+			glBufferData(GL_ARRAY_BUFFER, segmentSize * segmentCount, nullptr, GL_STREAM_DRAW);
+			for (auto &fence : fences)
+			{
+				fence.reset();
+			}
+			++orphanCount;
+		}
+		else
+		{
+			fences[segment].reset();
+		}
+	}
+
+	const GLintptr offset{ segment * segmentSize };
+	void* mapped{ glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT) };
+	if (!mapped)
+	{
+		std::cerr << "StreamBuffer::write(): failed to map segment\n";
+		return -1;
+	}
+	std::memcpy(mapped, data, size);
+	if (!glUnmapBuffer(GL_ARRAY_BUFFER))
+	{
+		std::cerr << "StreamBuffer::write(): buffer contents were lost\n";
+		return -1;
+	}
+	return offset;
+}
+
+// fence the last written segment after the commands reading it
+void StreamBuffer::fence()
+{
+	if (!buffer)
+	{
+		return;
+	}
+	fences[segment].reset(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+// retrieve the OpenGL buffer name
+GLuint StreamBuffer::getBuffer() const
+{
+	return buffer.get();
+}
+
+// retrieve how often a busy buffer was orphaned
+int StreamBuffer::getOrphanCount() const
+{
+	return orphanCount;
+}
@@ -0,0 +1,57 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "gl_handle.h"
+
+/*
+	Vertex buffer for data rewritten every frame. The buffer is split into
+	segments used round robin: each frame maps the next segment with an
+	unsynchronized write, and a fence placed after the draw that reads it
+	tells when the segment may be written again. If the GPU still holds
+	the segment, the buffer is orphaned instead of waited on, so writing
+	never stalls the CPU.
+*/
+class StreamBuffer
+{
+public:
+	// default constructor
+	StreamBuffer();
+
+	/*
+		Allocates the buffer.
+
+		segmentSize - size in bytes written each frame
+		segmentCount - amount of frames that may be in flight
+
+		Returns true on success and false on failure.
+	*/
+	bool create(GLsizeiptr segmentSize, int segmentCount = 3);
+
+	/*
+		Writes size bytes (at most segmentSize) into the next free segment.
+		The buffer is left bound to GL_ARRAY_BUFFER.
+
+		Returns the byte offset of the segment, or -1 on failure.
+	*/
+	GLintptr write(const void* data, GLsizeiptr size);
+
+	// fence the last written segment after the commands reading it
+	void fence();
+
+	GLuint getBuffer() const;		// retrieve the OpenGL buffer name
+	int getOrphanCount() const;		// retrieve how often a busy buffer was orphaned
+
+private:
+	GLBuffer buffer;
+	GLsizeiptr segmentSize;
+	int segmentCount;
+	int segment;
+	int orphanCount;
+
+	// fence of each segment, empty when the segment is free
+	std::vector<GLSync> fences;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "waterfall.h"
+#include "window.h"
+
+#include <algorithm>
+
+// entries of the colormap texture
+const int Waterfall::s_colormapSize{ 256 };
+
+// columnCount levels per row, rowCount rows, covering the given pixel area
+Waterfall::Waterfall(int columnCount, int rowCount, GLfloat left, GLfloat bottom, GLfloat width, GLfloat height)
+	: columnCount{ columnCount }, rowCount{ rowCount }, newestRow{ rowCount - 1 }
+{
+	program.loadProgram("waterfall.vert", "waterfall.frag");
+	program.use();
+	glUniform1i(glGetUniformLocation(program.getProgram(), "history"), 0);
+	glUniform1i(glGetUniformLocation(program.getProgram(), "colormap"), 1);
+	glUniform2f(glGetUniformLocation(program.getProgram(), "viewport"), static_cast<GLfloat>(Window::width), static_cast<GLfloat>(Window::height));
+	glUniform4f(glGetUniformLocation(program.getProgram(), "bounds"), left, bottom, width, height);
+	glUniform1f(glGetUniformLocation(program.getProgram(), "rowCount"), static_cast<GLfloat>(rowCount));
+	glUniform1f(glGetUniformLocation(program.getProgram(), "colormapSize"), static_cast<GLfloat>(s_colormapSize));
+	newestRowLocation = glGetUniformLocation(program.getProgram(), "newestRow");
+	scaleLocation = glGetUniformLocation(program.getProgram(), "scale");
+	glUseProgram(0);
+	setScale(1.0f);
+
+	// core profile draws need a vertex array object, even an empty one
+	VAO = GLCreate::vertexArray();
+
+	// history starts silent, rows wrap vertically so the shader can
+	// read past either end of the ring
+	const std::vector<GLfloat> silence(static_cast<std::size_t>(columnCount) * rowCount, 0.0f);
+	historyTexture = GLCreate::texture();
+	glBindTexture(GL_TEXTURE_2D, historyTexture.get());
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, columnCount, rowCount, 0, GL_RED, GL_FLOAT, silence.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	const std::vector<GLubyte> colormap{ makeColormap() };
+	colormapTexture = GLCreate::texture();
+	glBindTexture(GL_TEXTURE_1D, colormapTexture.get());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB8, s_colormapSize, 0, GL_RGB, GL_UNSIGNED_BYTE, colormap.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_1D, 0);
+}
+
+// write columnCount levels as the newest row
+void Waterfall::addRow(const GLfloat* levels)
+{
+	newestRow = (newestRow + 1) % rowCount;
+	glBindTexture(GL_TEXTURE_2D, historyTexture.get());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, newestRow, columnCount, 1, GL_RED, GL_FLOAT, levels);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// set the level shown at the top of the colormap
+void Waterfall::setScale(GLfloat maxLevel)
+{
+	program.use();
+	glUniform1f(scaleLocation, maxLevel > 0.0f ? 1.0f / maxLevel : 0.0f);
+	glUseProgram(0);
+}
+
+// draw the history, newest row at the top
+void Waterfall::draw()
+{
+	program.use();
+	glUniform1f(newestRowLocation, static_cast<GLfloat>(newestRow));
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, historyTexture.get());
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_1D, colormapTexture.get());
+	glBindVertexArray(VAO.get());
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_1D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// build colormapSize RGB entries from dark blue through red to pale yellow
+std::vector<GLubyte> Waterfall::makeColormap()
+{
+	// control points at evenly spaced levels
+	const GLfloat stops[][3] =
+	{
+		{ 0.00f, 0.00f, 0.02f },
+		{ 0.10f, 0.05f, 0.35f },
+		{ 0.45f, 0.07f, 0.50f },
+		{ 0.80f, 0.20f, 0.30f },
+		{ 0.98f, 0.55f, 0.05f },
+		{ 0.99f, 0.95f, 0.65f }
+	};
+	const int stopCount{ sizeof(stops) / sizeof(stops[0]) };
+
+	std::vector<GLubyte> colormap;
+	for (int entry{ 0 }; entry < s_colormapSize; ++entry)
+	{
+		const GLfloat position{ static_cast<GLfloat>(entry) / (s_colormapSize - 1) * (stopCount - 1) };
+		const int stop{ std::min(static_cast<int>(position), stopCount - 2) };
+		const GLfloat fraction{ position - stop };
+		for (int channel{ 0 }; channel < 3; ++channel)
+		{
+			const GLfloat value{ stops[stop][channel] + (stops[stop + 1][channel] - stops[stop][channel]) * fraction };
+			colormap.push_back(static_cast<GLubyte>(value * 255.0f + 0.5f));
+		}
+	}
+	return colormap;
+}
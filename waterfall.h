@@ -0,0 +1,51 @@
+#ifndef WATERFALL_H
+#define WATERFALL_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "shader_program.h"
+#include "gl_handle.h"
+
+/*
+	Scrolling spectrogram. History lives in a single-channel float texture
+	used as a circular buffer of rows: each analysis frame overwrites the
+	oldest row with glTexSubImage2D, and the fragment shader offsets its
+	row coordinate by the newest row so the image scrolls without moving
+	any texels. Levels are colored on the GPU through a colormap texture.
+	Adding a row costs one upload of columnCount floats, independent of
+	how much history is shown.
+*/
+class Waterfall
+{
+public:
+	/*
+		columnCount - amount of levels per row (one per band)
+		rowCount - amount of rows kept and shown
+		left, bottom, width, height - area covered in window pixels
+	*/
+	Waterfall(int columnCount, int rowCount, GLfloat left, GLfloat bottom, GLfloat width, GLfloat height);
+
+	void addRow(const GLfloat* levels);		// write columnCount levels as the newest row
+	void setScale(GLfloat maxLevel);		// set the level shown at the top of the colormap
+	void draw();							// draw the history, newest row at the top
+
+private:
+	static const int s_colormapSize;
+
+	// build colormapSize RGB entries from dark blue through red to pale yellow
+	static std::vector<GLubyte> makeColormap();
+
+	const int columnCount;
+	const int rowCount;
+	int newestRow;
+
+	ShaderProgram program;
+	GLint newestRowLocation;
+	GLint scaleLocation;
+
+	GLVertexArray VAO;
+	GLTexture historyTexture;
+	GLTexture colormapTexture;
+};
+
+#endif